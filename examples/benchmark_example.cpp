@@ -0,0 +1,562 @@
+// Micro benchmarks of the CPU side of the library (NURBS evaluation, OBJ and BMP loading,
+// mesh optimization, normal generation, mipmap generation and block compression). The inputs
+// are generated, so no asset files are needed (OBJ and BMP files are written to the working
+// directory and deleted afterwards).
+//
+// Each benchmark case is run until it has used at least the minimum time and the average
+// time per iteration is reported (similar to Google Benchmark).
+//
+// Usage:
+//   benchmark_example [--filter <substring>] [--min-time <seconds>] [--json <file>]
+//
+// The JSON output uses the same layout as Google Benchmark (--benchmark_format=json), so
+// existing tools for comparing benchmark runs can be used for regression tracking (the times
+// are wall clock times, so cpu_time is the same as real_time).
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Angel.h"
+#include "NURBSCurve.h"
+#include "NURBSSurface.h"
+#include "ObjLoader.h"
+#include "TextureLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshNormals.h"
+#include "MipmapGenerator.h"
+#include "BlockCompression.h"
+
+using namespace std;
+using namespace Angel;
+
+// Controls the timed loop of a benchmark:
+//   setup();
+//   while (state.keepRunning()){
+//       timedCode();
+//   }
+class BenchmarkState {
+public:
+	BenchmarkState(long long iterations)
+		:iterations(iterations), remaining(iterations), running(false), elapsedSeconds(0), itemsProcessed(0), bytesProcessed(0) {}
+
+	bool keepRunning(){
+		if (!running){
+			running = true;
+			start = chrono::steady_clock::now();
+		}
+		if (remaining-- > 0){
+			return true;
+		}
+		elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		return false;
+	}
+
+	long long iterations;
+	long long remaining;
+	bool running;
+	chrono::steady_clock::time_point start;
+	double elapsedSeconds;
+	// processed per iteration (used for items/s and bytes/s)
+	double itemsProcessed;
+	double bytesProcessed;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState &state, const vector<int> &args);
+
+struct BenchmarkCase {
+	string name; // name including the arguments e.g. "NURBSSurface::getMeshData/degree:3/controlPoints:8"
+	BenchmarkFunction function;
+	vector<int> args;
+};
+
+struct BenchmarkResult {
+	string name;
+	long long iterations;
+	double nanosecondsPerIteration;
+	double itemsPerSecond;
+	double bytesPerSecond;
+};
+
+vector<BenchmarkCase> benchmarks;
+
+// keeps the compiler from removing the benchmarked code
+volatile float sink;
+
+void addBenchmark(const string &name, BenchmarkFunction function, const vector<string> &argNames, const vector<int> &args){
+	BenchmarkCase benchmark;
+	stringstream fullName;
+	fullName << name;
+	for (unsigned int i = 0; i < args.size(); i++){
+		fullName << "/" << argNames[i] << ":" << args[i];
+	}
+	benchmark.name = fullName.str();
+	benchmark.function = function;
+	benchmark.args = args;
+	benchmarks.push_back(benchmark);
+}
+
+vector<int> makeArgs(int a, int b = -1, int c = -1){
+	vector<int> args;
+	args.push_back(a);
+	if (b >= 0){
+		args.push_back(b);
+	}
+	if (c >= 0){
+		args.push_back(c);
+	}
+	return args;
+}
+
+vector<string> makeArgNames(const char *a, const char *b = NULL, const char *c = NULL){
+	vector<string> names;
+	names.push_back(a);
+	if (b != NULL){
+		names.push_back(b);
+	}
+	if (c != NULL){
+		names.push_back(c);
+	}
+	return names;
+}
+
+// clamped uniform knot vector (the curve starts and ends in the first and last control point)
+vector<float> createKnotVector(int numberOfControlPoints, int degree){
+	vector<float> knots;
+	int spans = numberOfControlPoints - degree;
+	for (int i = 0; i <= degree; i++){
+		knots.push_back(0);
+	}
+	for (int i = 1; i < spans; i++){
+		knots.push_back(i / float(spans));
+	}
+	for (int i = 0; i <= degree; i++){
+		knots.push_back(1);
+	}
+	return knots;
+}
+
+float random01(){
+	return rand() / float(RAND_MAX);
+}
+
+// ---- NURBS
+
+// args: degree
+void benchmarkBasisFunction(BenchmarkState &state, const vector<int> &args){
+	int degree = args[0];
+	int numberOfControlPoints = 16;
+	vector<float> knots = createKnotVector(numberOfControlPoints, degree);
+	NURBSCurve curve(numberOfControlPoints);
+	const int samples = 64;
+	while (state.keepRunning()){
+		float sum = 0;
+		for (int s = 0; s < samples; s++){
+			float u = s / float(samples);
+			for (int i = 0; i < numberOfControlPoints; i++){
+				sum += curve.basisFunction(i, degree, u, knots);
+			}
+		}
+		sink = sum;
+	}
+	state.itemsProcessed = samples * numberOfControlPoints;
+}
+
+// args: degree, control points
+void benchmarkCurveEvaluate(BenchmarkState &state, const vector<int> &args){
+	int degree = args[0];
+	int numberOfControlPoints = args[1];
+	NURBSCurve curve(numberOfControlPoints);
+	for (int i = 0; i < numberOfControlPoints; i++){
+		curve.setControlPoint(i, vec4(i, random01(), random01(), 1 + random01()));
+	}
+	vector<float> knots = createKnotVector(numberOfControlPoints, degree);
+	curve.setKnotVector(knots.size(), &knots[0]);
+	const int samples = 256;
+	while (state.keepRunning()){
+		float sum = 0;
+		for (int s = 0; s < samples; s++){
+			sum += curve.evaluate(s / float(samples)).y;
+		}
+		sink = sum;
+	}
+	state.itemsProcessed = samples;
+}
+
+// args: degree, control points (in each direction), discretization (in each direction)
+void benchmarkSurfaceGetMeshData(BenchmarkState &state, const vector<int> &args){
+	int degree = args[0];
+	int numberOfControlPoints = args[1];
+	int discretization = args[2];
+	NURBSSurface surface(numberOfControlPoints, numberOfControlPoints, discretization, discretization);
+	for (int u = 0; u < numberOfControlPoints; u++){
+		for (int v = 0; v < numberOfControlPoints; v++){
+			surface.setControlPoint(u, v, vec4(u, v, random01(), 1 + random01()));
+		}
+	}
+	vector<float> knots = createKnotVector(numberOfControlPoints, degree);
+	surface.setKnotVectorU(knots.size(), &knots[0]);
+	surface.setKnotVectorV(knots.size(), &knots[0]);
+	while (state.keepRunning()){
+		vector<NURBSVertex> meshData = surface.getMeshData();
+		sink = meshData[meshData.size() / 2].position.z;
+	}
+	state.itemsProcessed = discretization * discretization;
+}
+
+// ---- OBJ
+
+// writes a grid with (at least) the given number of triangles (with normals and uvs)
+void writeObjGrid(const char *filename, int faceCount){
+	int size = 1;
+	while (2 * size * size < faceCount){
+		size++;
+	}
+	ofstream file(filename);
+	for (int y = 0; y <= size; y++){
+		for (int x = 0; x <= size; x++){
+			file << "v " << x << " " << y << " " << random01() << "\n";
+			file << "vn 0 0 1\n";
+			file << "vt " << x / float(size) << " " << y / float(size) << "\n";
+		}
+	}
+	for (int y = 0; y < size; y++){
+		for (int x = 0; x < size; x++){
+			int i = y * (size + 1) + x + 1; // OBJ indices starts at 1
+			int j = i + size + 1;
+			file << "f " << i << "/" << i << "/" << i << " " << (i+1) << "/" << (i+1) << "/" << (i+1) << " " << (j+1) << "/" << (j+1) << "/" << (j+1) << "\n";
+			file << "f " << i << "/" << i << "/" << i << " " << (j+1) << "/" << (j+1) << "/" << (j+1) << " " << j << "/" << j << "/" << j << "\n";
+		}
+	}
+}
+
+const char *OBJ_FILE = "benchmark_tmp.obj";
+const char *BMP_FILE = "benchmark_tmp.bmp";
+
+long long getFileSize(const char *filename){
+	ifstream file(filename, ios::binary | ios::ate);
+	return file.tellg();
+}
+
+// args: faces
+void benchmarkLoadObject(BenchmarkState &state, const vector<int> &args){
+	writeObjGrid(OBJ_FILE, args[0]);
+	while (state.keepRunning()){
+		vector<vec3> positions;
+		vector<int> indices;
+		vector<vec3> normals;
+		vector<vec2> uvs;
+		loadObject(OBJ_FILE, positions, indices, normals, uvs);
+		sink = positions.back().z;
+	}
+	state.itemsProcessed = args[0];
+	state.bytesProcessed = getFileSize(OBJ_FILE);
+	remove(OBJ_FILE);
+}
+
+// args: faces
+void benchmarkOptimizeMesh(BenchmarkState &state, const vector<int> &args){
+	writeObjGrid(OBJ_FILE, args[0]);
+	vector<vec3> positions;
+	vector<int> indices;
+	vector<vec3> normals;
+	vector<vec2> uvs;
+	loadObject(OBJ_FILE, positions, indices, normals, uvs);
+	remove(OBJ_FILE);
+	// shuffle the triangles (a grid is already close to optimal)
+	int triangleCount = indices.size() / 3;
+	for (int i = triangleCount - 1; i > 0; i--){
+		int j = rand() % (i + 1);
+		for (int k = 0; k < 3; k++){
+			swap(indices[i * 3 + k], indices[j * 3 + k]);
+		}
+	}
+	while (state.keepRunning()){
+		vector<int> optimizedIndices = indices;
+		vector<vec3> optimizedPositions = positions;
+		vector<vec3> optimizedNormals = normals;
+		vector<vec2> optimizedUvs = uvs;
+		MeshOptimizationStatistics stats = optimizeMesh(optimizedIndices, optimizedPositions, optimizedNormals, optimizedUvs);
+		sink = stats.acmrAfter;
+	}
+	state.itemsProcessed = triangleCount;
+}
+
+// cylinder (without caps) with a uv seam: the last column of vertices has the same positions
+// as the first column, but u = 1 instead of 0
+void createCylinder(int segments, int rings, vector<int> &indices, vector<vec3> &positions, vector<vec2> &uvs){
+	for (int y = 0; y <= rings; y++){
+		for (int x = 0; x <= segments; x++){
+			float angle = 2 * M_PI * (x % segments) / segments;
+			positions.push_back(vec3(cos(angle), y / float(rings), sin(angle)));
+			uvs.push_back(vec2(x / float(segments), y / float(rings)));
+		}
+	}
+	for (int y = 0; y < rings; y++){
+		for (int x = 0; x < segments; x++){
+			int i = y * (segments + 1) + x;
+			int j = i + segments + 1;
+			int triangle[] = {i, j + 1, i + 1, i, j, j + 1};
+			indices.insert(indices.end(), triangle, triangle + 6);
+		}
+	}
+}
+
+// args: faces
+void benchmarkGenerateNormals(BenchmarkState &state, const vector<int> &args){
+	int segments = 64;
+	int rings = max(1, args[0] / (2 * segments));
+	vector<int> indices;
+	vector<vec3> positions;
+	vector<vec2> uvs;
+	createCylinder(segments, rings, indices, positions, uvs);
+	while (state.keepRunning()){
+		vector<int> meshIndices = indices;
+		vector<vec3> meshPositions = positions;
+		vector<vec2> meshUvs = uvs;
+		vector<vec3> normals;
+		generateNormals(meshIndices, meshPositions, normals, meshUvs);
+		sink = normals[0].x;
+	}
+	state.itemsProcessed = indices.size() / 3;
+}
+
+// ---- Images
+
+// random noise RGBA image
+vector<unsigned char> createImage(int width, int height){
+	vector<unsigned char> rgba(width * height * 4);
+	for (unsigned int i = 0; i < rgba.size(); i++){
+		rgba[i] = rand() & 255;
+	}
+	return rgba;
+}
+
+// writes a BMP file with random pixels. 24 bit files use the 40 byte BITMAPINFOHEADER, 32 bit
+// files are written as BI_RGB with a V5 header (zero color masks, as written by most current tools)
+void writeBMP(const char *filename, int width, int height, int bitsPerPixel = 24){
+	int headerSize = bitsPerPixel == 32 ? 124 : 40;
+	int dataPos = 14 + headerSize;
+	int rowSize = (width * bitsPerPixel / 8 + 3) & ~3;
+	int dataSize = rowSize * height;
+	vector<unsigned char> header(dataPos, 0);
+	header[0] = 'B';
+	header[1] = 'M';
+	*(int*)&header[2] = dataPos + dataSize;
+	*(int*)&header[10] = dataPos;
+	*(int*)&header[14] = headerSize;
+	*(int*)&header[18] = width;
+	*(int*)&header[22] = height;
+	*(short*)&header[26] = 1;
+	*(short*)&header[28] = bitsPerPixel;
+	*(int*)&header[34] = dataSize;
+	vector<unsigned char> data(dataSize);
+	for (int i = 0; i < dataSize; i++){
+		data[i] = rand() & 255;
+	}
+	FILE *file = fopen(filename, "wb");
+	fwrite(&header[0], 1, dataPos, file);
+	fwrite(&data[0], 1, dataSize, file);
+	fclose(file);
+}
+
+// args: image size
+void benchmarkLoadBMPRaw(BenchmarkState &state, const vector<int> &args){
+	int size = args[0];
+	writeBMP(BMP_FILE, size, size);
+	while (state.keepRunning()){
+		unsigned int width, height;
+		unsigned char *data = loadBMPRaw(BMP_FILE, width, height);
+		sink = data[0];
+		delete [] data;
+	}
+	state.itemsProcessed = size * size;
+	state.bytesProcessed = getFileSize(BMP_FILE);
+	remove(BMP_FILE);
+}
+
+// args: image size, bits per pixel
+void benchmarkLoadBMPRGBA(BenchmarkState &state, const vector<int> &args){
+	int size = args[0];
+	int bitsPerPixel = args[1];
+	writeBMP(BMP_FILE, size, size, bitsPerPixel);
+	while (state.keepRunning()){
+		unsigned int width, height;
+		unsigned char *data = loadBMPRGBA(BMP_FILE, width, height);
+		sink = data[0];
+		delete [] data;
+	}
+	state.itemsProcessed = size * size;
+	state.bytesProcessed = getFileSize(BMP_FILE);
+	remove(BMP_FILE);
+}
+
+// args: image size
+void benchmarkGenerateMipmaps(BenchmarkState &state, const vector<int> &args){
+	int size = args[0];
+	vector<unsigned char> rgba = createImage(size, size);
+	while (state.keepRunning()){
+		MipmapChain chain;
+		generateMipmaps(&rgba[0], size, size, chain);
+		sink = chain.data.back();
+	}
+	state.itemsProcessed = size * size;
+	state.bytesProcessed = rgba.size();
+}
+
+// args: image size
+void benchmarkEncodeBC1(BenchmarkState &state, const vector<int> &args){
+	int size = args[0];
+	vector<unsigned char> rgba = createImage(size, size);
+	vector<unsigned char> blocks(getBC1Size(size, size));
+	while (state.keepRunning()){
+		encodeBC1(&rgba[0], size, size, &blocks[0]);
+		sink = blocks[0];
+	}
+	state.itemsProcessed = size * size;
+	state.bytesProcessed = rgba.size();
+}
+
+void registerBenchmarks(){
+	for (int degree = 1; degree <= 5; degree += 2){
+		addBenchmark("NURBS::basisFunction", benchmarkBasisFunction, makeArgNames("degree"), makeArgs(degree));
+	}
+	for (int degree = 2; degree <= 3; degree++){
+		for (int controlPoints = 8; controlPoints <= 32; controlPoints *= 4){
+			addBenchmark("NURBSCurve::evaluate", benchmarkCurveEvaluate, makeArgNames("degree", "controlPoints"), makeArgs(degree, controlPoints));
+		}
+	}
+	for (int degree = 2; degree <= 3; degree++){
+		for (int controlPoints = 4; controlPoints <= 8; controlPoints *= 2){
+			for (int discretization = 16; discretization <= 32; discretization *= 2){
+				addBenchmark("NURBSSurface::getMeshData", benchmarkSurfaceGetMeshData, makeArgNames("degree", "controlPoints", "discretization"), makeArgs(degree, controlPoints, discretization));
+			}
+		}
+	}
+	for (int faces = 1000; faces <= 100000; faces *= 10){
+		addBenchmark("loadObject", benchmarkLoadObject, makeArgNames("faces"), makeArgs(faces));
+	}
+	for (int faces = 1000; faces <= 100000; faces *= 10){
+		addBenchmark("optimizeMesh", benchmarkOptimizeMesh, makeArgNames("faces"), makeArgs(faces));
+	}
+	for (int faces = 1000; faces <= 100000; faces *= 10){
+		addBenchmark("generateNormals", benchmarkGenerateNormals, makeArgNames("faces"), makeArgs(faces));
+	}
+	for (int size = 256; size <= 2048; size *= 2){
+		addBenchmark("loadBMPRaw", benchmarkLoadBMPRaw, makeArgNames("size"), makeArgs(size));
+	}
+	for (int size = 256; size <= 1024; size *= 2){
+		for (int bitsPerPixel = 24; bitsPerPixel <= 32; bitsPerPixel += 8){
+			addBenchmark("loadBMPRGBA", benchmarkLoadBMPRGBA, makeArgNames("size", "bitsPerPixel"), makeArgs(size, bitsPerPixel));
+		}
+	}
+	for (int size = 256; size <= 1024; size *= 2){
+		addBenchmark("generateMipmaps", benchmarkGenerateMipmaps, makeArgNames("size"), makeArgs(size));
+	}
+	for (int size = 256; size <= 1024; size *= 2){
+		addBenchmark("encodeBC1", benchmarkEncodeBC1, makeArgNames("size"), makeArgs(size));
+	}
+}
+
+// runs the benchmark with an increasing number of iterations until it runs for at least minTime seconds
+BenchmarkResult runBenchmark(const BenchmarkCase &benchmark, double minTime){
+	long long iterations = 1;
+	while (true){
+		srand(1); // same input each run
+		BenchmarkState state(iterations);
+		benchmark.function(state, benchmark.args);
+		if (state.elapsedSeconds >= minTime || iterations >= 1000000000LL){
+			BenchmarkResult result;
+			result.name = benchmark.name;
+			result.iterations = iterations;
+			result.nanosecondsPerIteration = state.elapsedSeconds * 1e9 / iterations;
+			result.itemsPerSecond = state.itemsProcessed * iterations / state.elapsedSeconds;
+			result.bytesPerSecond = state.bytesProcessed * iterations / state.elapsedSeconds;
+			return result;
+		}
+		// estimate the iterations needed (with a margin) but grow at most 10 times
+		double estimate = state.elapsedSeconds > 0 ? minTime * 1.4 / (state.elapsedSeconds / iterations) : iterations * 10.0;
+		iterations = max(iterations + 1, min((long long)estimate, iterations * 10));
+	}
+}
+
+bool writeJson(const char *filename, const vector<BenchmarkResult> &results){
+	ofstream file(filename);
+	if (!file){
+		cerr << "Cannot write " << filename << endl;
+		return false;
+	}
+	file << "{\n";
+	file << "  \"context\": {\n";
+	file << "    \"executable\": \"benchmark_example\",\n";
+	file << "    \"library_build_type\": \"" <<
+#ifdef NDEBUG
+		"release"
+#else
+		"debug"
+#endif
+		<< "\"\n";
+	file << "  },\n";
+	file << "  \"benchmarks\": [\n";
+	for (unsigned int i = 0; i < results.size(); i++){
+		const BenchmarkResult &result = results[i];
+		file << "    {\n";
+		file << "      \"name\": \"" << result.name << "\",\n";
+		file << "      \"run_type\": \"iteration\",\n";
+		file << "      \"iterations\": " << result.iterations << ",\n";
+		file << "      \"real_time\": " << result.nanosecondsPerIteration << ",\n";
+		file << "      \"cpu_time\": " << result.nanosecondsPerIteration << ",\n";
+		file << "      \"time_unit\": \"ns\"";
+		if (result.itemsPerSecond > 0){
+			file << ",\n      \"items_per_second\": " << result.itemsPerSecond;
+		}
+		if (result.bytesPerSecond > 0){
+			file << ",\n      \"bytes_per_second\": " << result.bytesPerSecond;
+		}
+		file << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	file << "  ]\n";
+	file << "}\n";
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	string filter;
+	double minTime = 0.5;
+	const char *jsonFile = NULL;
+	for (int i = 1; i < argc; i++){
+		string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc){
+			filter = argv[++i];
+		} else if (arg == "--min-time" && i + 1 < argc){
+			minTime = atof(argv[++i]);
+		} else if (arg == "--json" && i + 1 < argc){
+			jsonFile = argv[++i];
+		} else {
+			cerr << "Usage: " << argv[0] << " [--filter <substring>] [--min-time <seconds>] [--json <file>]" << endl;
+			return 2;
+		}
+	}
+
+	registerBenchmarks();
+	vector<BenchmarkResult> results;
+	printf("%-64s %14s %12s %14s\n", "Benchmark", "Time (ns)", "Iterations", "Items/s");
+	for (unsigned int i = 0; i < benchmarks.size(); i++){
+		if (benchmarks[i].name.find(filter) == string::npos){
+			continue;
+		}
+		BenchmarkResult result = runBenchmark(benchmarks[i], minTime);
+		printf("%-64s %14.0f %12lld %14.4g\n", result.name.c_str(), result.nanosecondsPerIteration, result.iterations, result.itemsPerSecond);
+		fflush(stdout);
+		results.push_back(result);
+	}
+	if (jsonFile != NULL && !writeJson(jsonFile, results)){
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,236 @@
+// Checks the CPU side of the library (BMP decoding, normal generation and block compression)
+// on generated inputs with known results. No OpenGL context or asset files are needed (BMP
+// files are written to the working directory and deleted afterwards).
+//
+// Usage:
+//   check_example            runs all checks (returns 1 on failure)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Angel.h"
+#include "TextureLoader.h"
+#include "MeshNormals.h"
+#include "BlockCompression.h"
+
+using namespace std;
+using namespace Angel;
+
+const char *BMP_FILE = "check_tmp.bmp";
+
+int failures = 0;
+
+void check(bool ok, const string &name){
+	if (!ok){
+		cout << name << ": failed" << endl;
+		failures++;
+	} else {
+		cout << name << ": ok" << endl;
+	}
+}
+
+const int BI_RGB = 0;
+const int BI_BITFIELDS = 3;
+
+// writes a BMP file with random pixels and returns the pixel data (rows padded to 4 bytes).
+// headerSize is 40 (BITMAPINFOHEADER) or 124 (V5 header). The masks (red, green, blue and
+// alpha) are only written for BI_BITFIELDS.
+vector<unsigned char> writeBMP(const char *filename, int width, int height, int bitsPerPixel, int headerSize, int compression = BI_RGB, const unsigned int *masks = NULL){
+	int maskSize = compression == BI_BITFIELDS && headerSize == 40 ? 12 : 0;
+	int dataPos = 14 + headerSize + maskSize;
+	int rowSize = (width * bitsPerPixel / 8 + 3) & ~3;
+	int dataSize = rowSize * height;
+	vector<unsigned char> header(dataPos, 0);
+	header[0] = 'B';
+	header[1] = 'M';
+	*(int*)&header[2] = dataPos + dataSize;
+	*(int*)&header[10] = dataPos;
+	*(int*)&header[14] = headerSize;
+	*(int*)&header[18] = width;
+	*(int*)&header[22] = height;
+	*(short*)&header[26] = 1;
+	*(short*)&header[28] = bitsPerPixel;
+	*(int*)&header[30] = compression;
+	*(int*)&header[34] = dataSize;
+	if (compression == BI_BITFIELDS){
+		int maskCount = headerSize == 40 ? 3 : 4;
+		for (int i = 0; i < maskCount; i++){
+			*(unsigned int*)&header[54 + i * 4] = masks[i];
+		}
+	}
+	vector<unsigned char> data(dataSize);
+	for (int i = 0; i < dataSize; i++){
+		data[i] = rand() & 255;
+	}
+	FILE *file = fopen(filename, "wb");
+	fwrite(&header[0], 1, dataPos, file);
+	fwrite(&data[0], 1, dataSize, file);
+	fclose(file);
+	return data;
+}
+
+// ---- BMP
+
+// 32 bit BI_RGB with a V5 header (zero color masks, as written by most current tools) must be
+// decoded as BGRX with opaque pixels
+bool checkBMP32V5(){
+	int width = 5, height = 3;
+	vector<unsigned char> pixels = writeBMP(BMP_FILE, width, height, 32, 124);
+	unsigned int outWidth, outHeight;
+	unsigned char *data = loadBMPRGBA(BMP_FILE, outWidth, outHeight, false);
+	remove(BMP_FILE);
+	bool ok = data != NULL && (int)outWidth == width && (int)outHeight == height;
+	for (int i = 0; ok && i < width * height; i++){
+		const unsigned char *expected = &pixels[i * 4];
+		const unsigned char *actual = &data[i * 4];
+		ok = actual[0] == expected[2] && actual[1] == expected[1] && actual[2] == expected[0] && actual[3] == 255;
+	}
+	delete [] data;
+	return ok;
+}
+
+// loadBMPRaw keeps the padding of rows that are not a multiple of 4 bytes
+bool checkBMPRawPadding(){
+	int width = 7, height = 3;
+	int rowSize = (width * 3 + 3) & ~3;
+	vector<unsigned char> pixels = writeBMP(BMP_FILE, width, height, 24, 40);
+	bool ok = true;
+	for (int flip = 0; flip < 2; flip++){
+		unsigned int outWidth, outHeight;
+		unsigned char *data = loadBMPRaw(BMP_FILE, outWidth, outHeight, flip == 1);
+		ok = ok && data != NULL && (int)outWidth == width && (int)outHeight == height;
+		for (int y = 0; ok && y < height; y++){
+			int fileRow = flip ? height - 1 - y : y;
+			for (int i = 0; ok && i < width * 3; i++){
+				ok = data[y * rowSize + i] == pixels[fileRow * rowSize + i];
+			}
+		}
+		delete [] data;
+	}
+	remove(BMP_FILE);
+	return ok;
+}
+
+// a 32 bit mask must scale to 8 bits (0x80000000 gives 128), missing color masks give 0
+// and a missing alpha mask gives 255
+bool checkBMPWideMask(){
+	unsigned int masks[4] = {0xffffffff, 0, 0, 0};
+	int width = 4, height = 1;
+	vector<unsigned char> pixels = writeBMP(BMP_FILE, width, height, 32, 124, BI_BITFIELDS, masks);
+	unsigned int outWidth, outHeight;
+	unsigned char *data = loadBMPRGBA(BMP_FILE, outWidth, outHeight, false);
+	remove(BMP_FILE);
+	bool ok = data != NULL;
+	for (int x = 0; ok && x < width; x++){
+		unsigned int value = *(unsigned int*)&pixels[x * 4];
+		unsigned int expected = (unsigned int)(((unsigned long long)value * 255 + 0x7fffffffULL) / 0xffffffffULL);
+		ok = data[x * 4] == expected && data[x * 4 + 1] == 0 && data[x * 4 + 2] == 0 && data[x * 4 + 3] == 255;
+	}
+	delete [] data;
+	return ok;
+}
+
+// masks with holes are not supported
+bool checkBMPMaskWithHoles(){
+	unsigned int masks[4] = {0x00ff00ff, 0x0000ff00, 0, 0};
+	writeBMP(BMP_FILE, 4, 1, 32, 124, BI_BITFIELDS, masks);
+	unsigned int outWidth, outHeight;
+	unsigned char *data = loadBMPRGBA(BMP_FILE, outWidth, outHeight);
+	remove(BMP_FILE);
+	bool ok = data == NULL;
+	delete [] data;
+	return ok;
+}
+
+// ---- Normals
+
+// cylinder (without caps) with a uv seam: the last column of vertices has the same positions
+// as the first column, but u = 1 instead of 0
+void createCylinder(int segments, int rings, vector<int> &indices, vector<vec3> &positions, vector<vec2> &uvs){
+	for (int y = 0; y <= rings; y++){
+		for (int x = 0; x <= segments; x++){
+			float angle = 2 * M_PI * (x % segments) / segments;
+			positions.push_back(vec3(cos(angle), y / float(rings), sin(angle)));
+			uvs.push_back(vec2(x / float(segments), y / float(rings)));
+		}
+	}
+	for (int y = 0; y < rings; y++){
+		for (int x = 0; x < segments; x++){
+			int i = y * (segments + 1) + x;
+			int j = i + segments + 1;
+			int triangle[] = {i, j + 1, i + 1, i, j, j + 1};
+			indices.insert(indices.end(), triangle, triangle + 6);
+		}
+	}
+}
+
+// both sides of the uv seam must get the same normal
+bool checkNormalsUVSeam(){
+	int segments = 16, rings = 4;
+	vector<int> indices;
+	vector<vec3> positions;
+	vector<vec2> uvs;
+	vector<vec3> normals;
+	createCylinder(segments, rings, indices, positions, uvs);
+	generateNormals(indices, positions, normals, uvs);
+	for (int y = 0; y <= rings; y++){
+		int first = y * (segments + 1);
+		int last = first + segments;
+		if (dot(normals[first], normals[last]) < 0.9999f){
+			return false;
+		}
+	}
+	return true;
+}
+
+// ---- Block compression
+
+// a block of two colors must be encoded without error, also when the principal axis is
+// orthogonal to (1,1,1) as for red and green
+bool checkBC1TwoColors(const unsigned char *color0, const unsigned char *color1){
+	unsigned char rgba[4 * 4 * 4];
+	for (int i = 0; i < 16; i++){
+		const unsigned char *color = (i % 4) < 2 ? color0 : color1;
+		for (int c = 0; c < 4; c++){
+			rgba[i * 4 + c] = color[c];
+		}
+	}
+	vector<unsigned char> blocks(getBC1Size(4, 4));
+	unsigned char decoded[4 * 4 * 4];
+	encodeBC1(rgba, 4, 4, &blocks[0]);
+	decodeBC1(&blocks[0], 4, 4, decoded);
+	for (int i = 0; i < 16 * 4; i++){
+		if (decoded[i] != rgba[i]){
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc > 1){
+		cerr << "Usage: " << argv[0] << endl;
+		return 2;
+	}
+	srand(1);
+
+	check(checkBMP32V5(), "loadBMPRGBA 32 bpp BI_RGB V5 header");
+	check(checkBMPRawPadding(), "loadBMPRaw row padding");
+	check(checkBMPWideMask(), "loadBMPRGBA 32 bit color mask");
+	check(checkBMPMaskWithHoles(), "loadBMPRGBA color mask with holes");
+	check(checkNormalsUVSeam(), "generateNormals uv seam");
+	const unsigned char red[4] = {255, 0, 0, 255};
+	const unsigned char green[4] = {0, 255, 0, 255};
+	const unsigned char blue[4] = {0, 0, 255, 255};
+	check(checkBC1TwoColors(red, green), "encodeBC1 red/green block");
+	check(checkBC1TwoColors(red, blue), "encodeBC1 red/blue block");
+
+	if (failures > 0){
+		cout << failures << " failures" << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,278 @@
+// Renders the library features without a window (using HeadlessContext) and compares the
+// images with golden images. Each scene is rendered a number of times and the average frame
+// time is printed, which makes it possible to track rendering performance on a build server.
+//
+// Usage (run in the src directory, since the shaders are loaded from the working directory):
+//   headless_example --write-golden <dir>      write the golden images
+//   headless_example --golden <dir>            compare with the golden images (returns 1 on failure)
+//   headless_example --frames <count>          number of frames per scene (default 100)
+//
+// Golden images depend on the renderer - use the same renderer (e.g. LIBGL_ALWAYS_SOFTWARE=1
+// for Mesa llvmpipe) when writing and comparing.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+
+#include "Angel.h"
+#include "HeadlessContext.h"
+#include "ShaderRegistry.h"
+#include "Texture.h"
+#include "FrameBufferObject.h"
+#include "Select.h"
+#include "NURBSSurface.h"
+#include "NURBSRenderer.h"
+
+using namespace std;
+using namespace Angel;
+
+const int WIDTH = 256;
+const int HEIGHT = 256;
+// max difference of a color component (allows small differences between driver versions)
+const int TOLERANCE = 2;
+
+HeadlessContext *context = NULL;
+string goldenDirectory;
+bool writeGolden = false;
+int frames = 100;
+int failures = 0;
+
+NURBSSurface *surface = NULL;
+NURBSRenderer *nurbsRenderer = NULL;
+
+GLuint shaderProgram;
+GLint projectionUniform,
+	modelViewUniform,
+	colorUniform;
+GLuint quadGeometryVAO;
+
+const char *vertexShaderSource =
+	"#version 150\n"
+	"uniform mat4 projection;\n"
+	"uniform mat4 modelView;\n"
+	"in vec4 position;\n"
+	"void main(void){\n"
+	"	gl_Position = projection * modelView * position;\n"
+	"}\n";
+
+const char *fragmentShaderSource =
+	"#version 150\n"
+	"uniform vec4 color;\n"
+	"out vec4 fragColour;\n"
+	"void main(void){\n"
+	"	fragColour = color;\n"
+	"}\n";
+
+double getTimeMs(){
+	return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// renders the scene the given number of frames, prints the time per frame and compares
+// the last frame with the golden image (<goldenDirectory>/<imageName>.ppm). The golden image
+// is only written by the scene with the same name (other scenes must give the same image)
+void runScene(const string &name, const string &imageName, void (*renderScene)()){
+	double start = getTimeMs();
+	for (int i = 0; i < frames; i++){
+		renderScene();
+	}
+	glFinish();
+	double frameTime = (getTimeMs() - start) / frames;
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR){
+		cout << name << ": OpenGL error 0x" << hex << error << dec << endl;
+		failures++;
+	}
+	string filename = goldenDirectory + "/" + imageName + ".ppm";
+	if (writeGolden && name == imageName){
+		context->saveImage(filename);
+		cout << name << ": " << frameTime << " ms/frame (wrote " << filename << ")" << endl;
+	} else if (!goldenDirectory.empty()){
+		int differentPixels = context->compareImage(filename, TOLERANCE);
+		if (differentPixels != 0){
+			failures++;
+		}
+		cout << name << ": " << frameTime << " ms/frame, " << differentPixels << " pixels differ from " << filename << endl;
+	} else {
+		cout << name << ": " << frameTime << " ms/frame" << endl;
+	}
+}
+
+void setupNURBS(){
+	surface = new NURBSSurface(4, 4, 32, 32);
+	for (int u = 0; u < 4; u++){
+		for (int v = 0; v < 4; v++){
+			float height = (u == 1 || u == 2) && (v == 1 || v == 2) ? 1.5f : 0.0f;
+			surface->setControlPoint(u, v, vec3(1.5f - u, v - 1.5f, height));
+		}
+	}
+	float knotVector[] = {0, 0, 0, 0, 1, 1, 1, 1};
+	surface->setKnotVectorU(8, knotVector);
+	surface->setKnotVectorV(8, knotVector);
+	nurbsRenderer = new NURBSRenderer(surface);
+	nurbsRenderer->setColor(vec4(1, 0.5f, 0, 1));
+}
+
+void renderNURBS(){
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, WIDTH, HEIGHT);
+	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glEnable(GL_DEPTH_TEST);
+	mat4 projection = Ortho(-2.5, 2.5, -2.5, 2.5, -10, 10);
+	mat4 modelView = RotateX(-60);
+	NURBSRenderer::beginFrame(projection, vec4(0, 0, 10, 1));
+	nurbsRenderer->render(modelView);
+	nurbsRenderer->renderControlPoints(modelView);
+	glDisable(GL_DEPTH_TEST);
+}
+
+Texture *offscreenTexture = NULL;
+FrameBufferObject *offscreenFramebuffer = NULL;
+
+// renders the NURBS surface into a texture and draws the texture on the screen
+void renderFramebuffer(){
+	offscreenFramebuffer->bind();
+	glViewport(0, 0, WIDTH / 2, HEIGHT / 2);
+	glClearColor(0.0f, 0.0f, 0.4f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glEnable(GL_DEPTH_TEST);
+	NURBSRenderer::beginFrame(Ortho(-2.5, 2.5, -2.5, 2.5, -10, 10), vec4(0, 0, 10, 1));
+	nurbsRenderer->render(RotateX(-30));
+	glDisable(GL_DEPTH_TEST);
+	offscreenFramebuffer->unbind();
+
+	glViewport(0, 0, WIDTH, HEIGHT);
+	glClear(GL_COLOR_BUFFER_BIT);
+	offscreenTexture->renderFullscreenQuad();
+	NURBSRenderer::invalidateStateCache();
+}
+
+void setupQuads(){
+	shaderProgram = ShaderRegistry::getProgramFromSource(vertexShaderSource, fragmentShaderSource, "fragColour");
+	projectionUniform = glGetUniformLocation(shaderProgram, "projection");
+	modelViewUniform = glGetUniformLocation(shaderProgram, "modelView");
+	colorUniform = glGetUniformLocation(shaderProgram, "color");
+	GLuint positionAttribute = glGetAttribLocation(shaderProgram, "position");
+
+	vec4 vertexData[4] = {
+		vec4(-0.5, -0.5, 0.0, 1.0 ),
+		vec4( 0.5, -0.5, 0.0, 1.0 ),
+		vec4( 0.5,  0.5, 0.0, 1.0 ),
+		vec4(-0.5,  0.5, 0.0, 1.0 )
+	};
+	glGenVertexArrays(1, &quadGeometryVAO);
+	glBindVertexArray(quadGeometryVAO);
+	GLuint vertexBuffer;
+	glGenBuffers(1, &vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(positionAttribute);
+	glVertexAttribPointer(positionAttribute, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (const GLvoid *)0);
+	glBindVertexArray(0);
+}
+
+SelectBuffer *selectBuffer = NULL;
+
+// 3x3 quads (as in select_example.cpp)
+void renderQuads(bool select){
+	glUseProgram(shaderProgram);
+	glUniformMatrix4fv(projectionUniform, 1, GL_TRUE, Ortho(0.0, 3, 0.0, 3, -1.0, 1.0));
+	glBindVertexArray(quadGeometryVAO);
+	int index = 0;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (select){
+				selectBuffer->setId(index);
+			} else {
+				glUniform4fv(colorUniform, 1, vec4(i / 3.0, j / 3.0, 0.5, 1.0));
+			}
+			glUniformMatrix4fv(modelViewUniform, 1, GL_TRUE, Translate(0.5 + i, 0.5 + j, 0));
+			glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+			index++;
+		}
+	}
+	glBindVertexArray(0);
+}
+
+int selectErrors = 0;
+
+// renders the select buffer and picks the center of each quad
+void renderSelect(){
+	selectBuffer->setColorUniform(colorUniform);
+	glUseProgram(shaderProgram);
+	selectBuffer->bind();
+	renderQuads(true);
+	selectBuffer->release();
+	for (int i = 0; i < 9; i++){
+		int x = (i / 3) * WIDTH / 3 + WIDTH / 6;
+		int y = (i % 3) * HEIGHT / 3 + HEIGHT / 6;
+		if (selectBuffer->getId(x, y) != i){
+			selectErrors++;
+		}
+	}
+
+	glViewport(0, 0, WIDTH, HEIGHT);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	renderQuads(false);
+	NURBSRenderer::invalidateStateCache();
+}
+
+int main(int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++){
+		string arg = argv[i];
+		if (arg == "--golden" && i + 1 < argc){
+			goldenDirectory = argv[++i];
+		} else if (arg == "--write-golden" && i + 1 < argc){
+			goldenDirectory = argv[++i];
+			writeGolden = true;
+		} else if (arg == "--frames" && i + 1 < argc){
+			frames = max(1, atoi(argv[++i]));
+		} else {
+			cerr << "Usage: " << argv[0] << " [--golden <dir> | --write-golden <dir>] [--frames <count>]" << endl;
+			return 2;
+		}
+	}
+
+	context = new HeadlessContext(WIDTH, HEIGHT);
+	if (!context->isValid()){
+		return 2;
+	}
+	cout << "Renderer: " << context->getRendererString() << endl;
+
+	setupNURBS();
+	runScene("nurbs", "nurbs", renderNURBS);
+	if (nurbsRenderer->setGPUEvaluation(true)){
+		// must give the same image as the CPU evaluation
+		runScene("nurbs_gpu", "nurbs", renderNURBS);
+		nurbsRenderer->setGPUEvaluation(false);
+	}
+
+	offscreenTexture = new Texture(WIDTH / 2, HEIGHT / 2);
+	offscreenFramebuffer = new FrameBufferObject(offscreenTexture);
+	runScene("framebuffer", "framebuffer", renderFramebuffer);
+
+	setupQuads();
+	selectBuffer = new SelectBuffer(WIDTH, HEIGHT);
+	runScene("select", "select", renderSelect);
+	if (selectErrors > 0){
+		cout << "select: " << selectErrors << " wrong ids" << endl;
+		failures++;
+	}
+
+	delete selectBuffer;
+	delete offscreenFramebuffer;
+	delete offscreenTexture;
+	delete nurbsRenderer;
+	delete surface;
+	delete context;
+
+	if (failures > 0){
+		cout << failures << " failures" << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -80,10 +80,13 @@ void reshape(int W, int H) {
 	WINDOW_WIDTH = W;
 	WINDOW_HEIGHT = H;
 	glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-	if (selectBuffer != NULL){
-		delete selectBuffer;
+	if (selectBuffer == NULL){
+		selectBuffer = new SelectBuffer(W,H);
+		selectBuffer->setCpuCopy(true);
+	} else {
+		// reuses the storage when the window shrinks (and marks the select buffer dirty)
+		selectBuffer->resize(W,H);
 	}
-	selectBuffer = new SelectBuffer(W,H);
 }
 
 GLuint loadBufferData() {
@@ -125,12 +128,17 @@ void pickSquares(int button, int state, int x, int y) {
 	if (button != GLUT_LEFT_BUTTON || state != GLUT_DOWN)
 		return;
 
-	selectBuffer->setColorUniform(colorUniform);
-	selectBuffer->bind();
-	renderScene(true);
+	// the ids does not change when the board colors changes - so the select buffer is only 
+	// rendered after the window has been resized
+	if (selectBuffer->isDirty()){
+		selectBuffer->setColorUniform(colorUniform);
+		selectBuffer->bind();
+		renderScene(true);
+		selectBuffer->release();
+		glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+	}
 	int id = selectBuffer->getId(x,WINDOW_HEIGHT-y);
 
-	selectBuffer->release();
 	if (id >= 0){
 		board[id] = (board[id] + 1) % 3;
 		glutPostRedisplay();
@@ -0,0 +1,284 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "AsyncTextureLoader.h"
+#include "TextureLoader.h"
+#include "Profiler.h"
+
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+AsyncTextureLoader::AsyncTextureLoader(int workerCount, int uploadBytesPerFrame, int stagingBufferCount)
+:uploadBytesPerFrame(uploadBytesPerFrame), pendingCount(0), uploading(false), uploadedRows(0), stopping(false){
+	// placeholder shown until textures are uploaded
+	unsigned char grey[4] = {128, 128, 128, 255};
+	glGenTextures(1, &placeholderTextureId);
+	glBindTexture(GL_TEXTURE_2D, placeholderTextureId);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenBuffers(1, &pixelBufferId);
+
+	for (int i=0;i<stagingBufferCount;i++){
+		stagingBuffers.push_back(new vector<unsigned char>());
+	}
+	freeStagingBuffers = stagingBuffers;
+	for (int i=0;i<workerCount;i++){
+		workers.push_back(thread(&AsyncTextureLoader::workerLoop, this));
+	}
+}
+
+AsyncTextureLoader::~AsyncTextureLoader(){
+	{
+		unique_lock<mutex> lock(queueMutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	stagingBufferAvailable.notify_all();
+	for (int i=0;i<workers.size();i++){
+		workers[i].join();
+	}
+	for (int i=0;i<stagingBuffers.size();i++){
+		delete stagingBuffers[i];
+	}
+	for (int i=0;i<entries.size();i++){
+		if (entries[i].textureId != 0){
+			glDeleteTextures(1, &entries[i].textureId);
+		}
+	}
+	glDeleteTextures(1, &placeholderTextureId);
+	glDeleteBuffers(1, &pixelBufferId);
+}
+
+int AsyncTextureLoader::load(const char * imagepath, bool flipY, bool mipmaps){
+	Entry entry;
+	entry.state = DECODING;
+	entry.textureId = 0;
+	entry.width = 0;
+	entry.height = 0;
+	entry.mipmaps = mipmaps;
+	int handle = entries.size();
+	entries.push_back(entry);
+
+	DecodeJob job;
+	job.handle = handle;
+	job.imagepath = imagepath;
+	job.flipY = flipY;
+	job.pixels = NULL;
+	job.width = 0;
+	job.height = 0;
+	job.ok = false;
+	{
+		unique_lock<mutex> lock(queueMutex);
+		decodeQueue.push_back(job);
+	}
+	pendingCount++;
+	jobAvailable.notify_one();
+	return handle;
+}
+
+void AsyncTextureLoader::workerLoop(){
+	while (true){
+		DecodeJob job;
+		{
+			unique_lock<mutex> lock(queueMutex);
+			while (!stopping && (decodeQueue.empty() || freeStagingBuffers.empty())){
+				if (decodeQueue.empty()){
+					jobAvailable.wait(lock);
+				} else {
+					stagingBufferAvailable.wait(lock);
+				}
+			}
+			if (stopping){
+				return;
+			}
+			job = decodeQueue.front();
+			decodeQueue.pop_front();
+			job.pixels = freeStagingBuffers.back();
+			freeStagingBuffers.pop_back();
+		}
+		job.ok = decode(job);
+		{
+			unique_lock<mutex> lock(queueMutex);
+			uploadQueue.push_back(job);
+		}
+	}
+}
+
+bool AsyncTextureLoader::decode(DecodeJob &job){
+	MappedBMP bmp(job.imagepath.c_str());
+	if (!bmp.isValid()){
+		return false;
+	}
+	job.width = bmp.getWidth();
+	job.height = bmp.getHeight();
+	job.pixels->resize(job.width * job.height * 4); // reuses the capacity of the staging buffer
+	if (job.pixels->empty()){
+		return false;
+	}
+	return bmp.decodeRGBA(&((*job.pixels)[0]), job.flipY);
+}
+
+void AsyncTextureLoader::releaseStagingBuffer(vector<unsigned char> *buffer){
+	{
+		unique_lock<mutex> lock(queueMutex);
+		freeStagingBuffers.push_back(buffer);
+	}
+	stagingBufferAvailable.notify_one();
+}
+
+void AsyncTextureLoader::uploadRows(DecodeJob &job, int &budget){
+	Entry &entry = entries[job.handle];
+	int rowSize = job.width * 4;
+	if (uploadedRows == 0){
+		glGenTextures(1, &entry.textureId);
+		glBindTexture(GL_TEXTURE_2D, entry.textureId);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, entry.mipmaps?GL_LINEAR_MIPMAP_LINEAR:GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, job.width, job.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		entry.width = job.width;
+		entry.height = job.height;
+	} else {
+		glBindTexture(GL_TEXTURE_2D, entry.textureId);
+	}
+	// upload at least one row per frame
+	int rows = budget / rowSize;
+	if (rows < 1){
+		rows = 1;
+	}
+	if (rows > job.height - uploadedRows){
+		rows = job.height - uploadedRows;
+	}
+	int bytes = rows * rowSize;
+	if (bytes > 0){
+		PROFILE_GPU_SCOPE("AsyncTextureLoader::upload");
+		PROFILE_BYTES_UPLOADED(bytes);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBufferId);
+		// orphan the previous storage so the driver does not wait for the last upload
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+		void *destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (destination != NULL){
+			memcpy(destination, &((*job.pixels)[rowSize*uploadedRows]), bytes);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, uploadedRows, job.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid *)0);
+		} else {
+			cerr << "Could not map pixel buffer object" << endl;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	uploadedRows += rows;
+	budget -= bytes;
+	if (uploadedRows == job.height){
+		if (entry.mipmaps){
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
+		entry.state = READY;
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void AsyncTextureLoader::update(){
+	int budget = uploadBytesPerFrame;
+	while (budget > 0){
+		if (!uploading){
+			{
+				unique_lock<mutex> lock(queueMutex);
+				if (uploadQueue.empty()){
+					return;
+				}
+				currentUpload = uploadQueue.front();
+				uploadQueue.pop_front();
+			}
+			uploading = true;
+			uploadedRows = 0;
+			Entry &entry = entries[currentUpload.handle];
+			if (!currentUpload.ok || entry.state == RELEASED){
+				if (entry.state != RELEASED){
+					cerr << "Could not load texture " << currentUpload.imagepath << endl;
+					entry.state = FAILED;
+				}
+				releaseStagingBuffer(currentUpload.pixels);
+				uploading = false;
+				pendingCount--;
+				continue;
+			}
+			entry.state = UPLOADING;
+		}
+		uploadRows(currentUpload, budget);
+		if (uploadedRows < currentUpload.height){
+			return;
+		}
+		releaseStagingBuffer(currentUpload.pixels);
+		uploading = false;
+		pendingCount--;
+	}
+}
+
+GLuint AsyncTextureLoader::getTextureId(int handle){
+	if (entries[handle].state != READY){
+		return placeholderTextureId;
+	}
+	return entries[handle].textureId;
+}
+
+bool AsyncTextureLoader::isReady(int handle){
+	return entries[handle].state == READY;
+}
+
+bool AsyncTextureLoader::hasFailed(int handle){
+	return entries[handle].state == FAILED;
+}
+
+unsigned int AsyncTextureLoader::getWidth(int handle){
+	return entries[handle].width;
+}
+
+unsigned int AsyncTextureLoader::getHeight(int handle){
+	return entries[handle].height;
+}
+
+int AsyncTextureLoader::getPendingCount(){
+	return pendingCount;
+}
+
+void AsyncTextureLoader::release(int handle){
+	Entry &entry = entries[handle];
+	if (entry.state == UPLOADING && uploading && currentUpload.handle == handle){
+		// abort the current upload
+		releaseStagingBuffer(currentUpload.pixels);
+		uploading = false;
+		pendingCount--;
+	}
+	if (entry.textureId != 0){
+		glDeleteTextures(1, &entry.textureId);
+		entry.textureId = 0;
+	}
+	entry.state = RELEASED;
+}
@@ -0,0 +1,118 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __ASYNC_TEXTURE_LOADER_H
+#define __ASYNC_TEXTURE_LOADER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Angel.h"
+
+// Loads BMP textures (any format supported by loadBMPRGBA) without blocking the render loop.
+// Worker threads decode the files into a pool of staging buffers and update() (called 
+// once per frame on the OpenGL thread) uploads at most uploadBytesPerFrame bytes through 
+// a pixel buffer object. Until a texture is ready getTextureId returns a 1x1 placeholder.
+// The number of staging buffers limits the amount of decoded images kept in memory.
+//
+// Example usage:
+// AsyncTextureLoader *loader = new AsyncTextureLoader();
+// int brick = loader->load("brick.bmp");
+// void display(){
+//     loader->update();
+//     glBindTexture(GL_TEXTURE_2D, loader->getTextureId(brick));
+//     ...
+// }
+class AsyncTextureLoader {
+public:
+	// Must be created on the OpenGL thread
+	AsyncTextureLoader(int workerCount = 2, int uploadBytesPerFrame = 4*1024*1024, int stagingBufferCount = 4);
+	~AsyncTextureLoader();
+	// queue an image for loading - returns a handle
+	int load(const char * imagepath, bool flipY = true, bool mipmaps = true);
+	// upload decoded images (must be called on the OpenGL thread, e.g. once per frame)
+	void update();
+	// returns the texture or the placeholder texture if not ready
+	GLuint getTextureId(int handle);
+	bool isReady(int handle);
+	bool hasFailed(int handle);
+	unsigned int getWidth(int handle);
+	unsigned int getHeight(int handle);
+	// number of images not uploaded yet
+	int getPendingCount();
+	// delete the texture of the handle (the handle must not be used afterwards)
+	void release(int handle);
+private:
+	enum State { DECODING, UPLOADING, READY, FAILED, RELEASED };
+	struct Entry {
+		State state;
+		GLuint textureId;
+		unsigned int width;
+		unsigned int height;
+		bool mipmaps;
+	};
+	struct DecodeJob {
+		int handle;
+		std::string imagepath;
+		bool flipY;
+		std::vector<unsigned char> *pixels; // staging buffer (tightly packed RGBA rows)
+		unsigned int width;
+		unsigned int height;
+		bool ok;
+	};
+	AsyncTextureLoader(const AsyncTextureLoader&);
+	AsyncTextureLoader& operator=(const AsyncTextureLoader&);
+	void workerLoop();
+	bool decode(DecodeJob &job);
+	// upload the next rows of the job within the byte budget of the frame
+	void uploadRows(DecodeJob &job, int &budget);
+	void releaseStagingBuffer(std::vector<unsigned char> *buffer);
+
+	std::vector<Entry> entries;
+	GLuint placeholderTextureId;
+	GLuint pixelBufferId;
+	int uploadBytesPerFrame;
+	int pendingCount;
+
+	// current upload (only used on the OpenGL thread)
+	bool uploading;
+	DecodeJob currentUpload;
+	unsigned int uploadedRows;
+
+	std::vector<std::thread> workers;
+	std::mutex queueMutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable stagingBufferAvailable;
+	bool stopping;
+	std::deque<DecodeJob> decodeQueue;
+	std::deque<DecodeJob> uploadQueue;
+	std::vector<std::vector<unsigned char>*> stagingBuffers;
+	std::vector<std::vector<unsigned char>*> freeStagingBuffers;
+};
+
+#endif
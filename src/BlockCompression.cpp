@@ -0,0 +1,308 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "BlockCompression.h"
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+int getBC1Size(int width, int height){
+	return max(1, (width+3)/4) * max(1, (height+3)/4) * 8;
+}
+
+int getBC3Size(int width, int height){
+	return max(1, (width+3)/4) * max(1, (height+3)/4) * 16;
+}
+
+// copy a 4x4 block (repeating the edge pixels of partial blocks)
+static void fetchBlock(const unsigned char * rgba, int width, int height, int blockX, int blockY, unsigned char * outBlock){
+	for (int y=0;y<4;y++){
+		int sy = min(blockY*4 + y, height-1);
+		for (int x=0;x<4;x++){
+			int sx = min(blockX*4 + x, width-1);
+			memcpy(outBlock + (y*4+x)*4, rgba + (sy*width + sx)*4, 4);
+		}
+	}
+}
+
+static void storeBlock(const unsigned char * block, int width, int height, int blockX, int blockY, unsigned char * outRgba){
+	for (int y=0;y<4 && blockY*4 + y < height;y++){
+		for (int x=0;x<4 && blockX*4 + x < width;x++){
+			memcpy(outRgba + ((blockY*4+y)*width + blockX*4+x)*4, block + (y*4+x)*4, 4);
+		}
+	}
+}
+
+static unsigned short toRGB565(const float * color){
+	int r = (int)(max(0.0f, min(255.0f, color[0])) * 31.0f / 255.0f + 0.5f);
+	int g = (int)(max(0.0f, min(255.0f, color[1])) * 63.0f / 255.0f + 0.5f);
+	int b = (int)(max(0.0f, min(255.0f, color[2])) * 31.0f / 255.0f + 0.5f);
+	return (r << 11) | (g << 5) | b;
+}
+
+static void fromRGB565(unsigned short color, unsigned char * outRgb){
+	int r = (color >> 11) & 31;
+	int g = (color >> 5) & 63;
+	int b = color & 31;
+	outRgb[0] = (r << 3) | (r >> 2);
+	outRgb[1] = (g << 2) | (g >> 4);
+	outRgb[2] = (b << 3) | (b >> 2);
+}
+
+// the four colors of a BC1 block (3 colors and black/transparent if color0 <= color1)
+static void getPalette(unsigned short color0, unsigned short color1, bool forceFourColors, unsigned char outPalette[4][4]){
+	fromRGB565(color0, outPalette[0]);
+	fromRGB565(color1, outPalette[1]);
+	outPalette[0][3] = outPalette[1][3] = 255;
+	if (color0 > color1 || forceFourColors){
+		for (int c=0;c<3;c++){
+			outPalette[2][c] = (2*outPalette[0][c] + outPalette[1][c]) / 3;
+			outPalette[3][c] = (outPalette[0][c] + 2*outPalette[1][c]) / 3;
+		}
+		outPalette[2][3] = outPalette[3][3] = 255;
+	} else {
+		for (int c=0;c<3;c++){
+			outPalette[2][c] = (outPalette[0][c] + outPalette[1][c]) / 2;
+			outPalette[3][c] = 0;
+		}
+		outPalette[2][3] = 255;
+		outPalette[3][3] = 0;
+	}
+}
+
+static void encodeColorBlock(const unsigned char * block, unsigned char * out){
+	// mean and covariance of the colors
+	float mean[3] = {0,0,0};
+	for (int i=0;i<16;i++){
+		for (int c=0;c<3;c++){
+			mean[c] += block[i*4+c] / 16.0f;
+		}
+	}
+	float covariance[6] = {0,0,0,0,0,0};
+	for (int i=0;i<16;i++){
+		float r = block[i*4] - mean[0];
+		float g = block[i*4+1] - mean[1];
+		float b = block[i*4+2] - mean[2];
+		covariance[0] += r*r; covariance[1] += r*g; covariance[2] += r*b;
+		covariance[3] += g*g; covariance[4] += g*b; covariance[5] += b*b;
+	}
+	// principal axis using power iteration. Starts from the channel with the largest variance
+	// (a fixed start like (1,1,1) fails when the axis is orthogonal to it, e.g. red/green blocks),
+	// which is also used if the iteration degenerates
+	const int varianceIndex[3] = {0,3,5}; // diagonal of the covariance
+	int maxVarianceChannel = 0;
+	for (int c=1;c<3;c++){
+		if (covariance[varianceIndex[c]] > covariance[varianceIndex[maxVarianceChannel]]){
+			maxVarianceChannel = c;
+		}
+	}
+	float axis[3] = {0,0,0};
+	axis[maxVarianceChannel] = 1;
+	for (int iteration=0;iteration<8;iteration++){
+		float x = covariance[0]*axis[0] + covariance[1]*axis[1] + covariance[2]*axis[2];
+		float y = covariance[1]*axis[0] + covariance[3]*axis[1] + covariance[4]*axis[2];
+		float z = covariance[2]*axis[0] + covariance[4]*axis[1] + covariance[5]*axis[2];
+		float length = max(fabs(x), max(fabs(y), fabs(z)));
+		if (length == 0){
+			break;
+		}
+		axis[0] = x/length; axis[1] = y/length; axis[2] = z/length;
+	}
+	// endpoints are the extreme projections on the axis
+	float minProjection = 1e30f, maxProjection = -1e30f;
+	for (int i=0;i<16;i++){
+		float projection = (block[i*4]-mean[0])*axis[0] + (block[i*4+1]-mean[1])*axis[1] + (block[i*4+2]-mean[2])*axis[2];
+		minProjection = min(minProjection, projection);
+		maxProjection = max(maxProjection, projection);
+	}
+	float axisLength2 = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+	float endpoint0[3], endpoint1[3];
+	for (int c=0;c<3;c++){
+		endpoint0[c] = mean[c] + axis[c] * maxProjection / max(axisLength2, 1e-8f);
+		endpoint1[c] = mean[c] + axis[c] * minProjection / max(axisLength2, 1e-8f);
+	}
+	unsigned short color0 = toRGB565(endpoint0);
+	unsigned short color1 = toRGB565(endpoint1);
+	if (color0 < color1){
+		swap(color0, color1);
+	}
+	unsigned int indices = 0;
+	if (color0 != color1){
+		unsigned char palette[4][4];
+		getPalette(color0, color1, true, palette);
+		for (int i=0;i<16;i++){
+			int bestIndex = 0;
+			int bestDistance = 1 << 30;
+			for (int p=0;p<4;p++){
+				int dr = block[i*4] - palette[p][0];
+				int dg = block[i*4+1] - palette[p][1];
+				int db = block[i*4+2] - palette[p][2];
+				int distance = dr*dr + dg*dg + db*db;
+				if (distance < bestDistance){
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i*2);
+		}
+	}
+	out[0] = color0 & 0xff;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xff;
+	out[3] = color1 >> 8;
+	for (int i=0;i<4;i++){
+		out[4+i] = (indices >> (i*8)) & 0xff;
+	}
+}
+
+static void decodeColorBlock(const unsigned char * in, bool forceFourColors, unsigned char * outBlock){
+	unsigned short color0 = in[0] | (in[1] << 8);
+	unsigned short color1 = in[2] | (in[3] << 8);
+	unsigned char palette[4][4];
+	getPalette(color0, color1, forceFourColors, palette);
+	for (int i=0;i<16;i++){
+		int index = (in[4 + i/4] >> ((i%4)*2)) & 3;
+		memcpy(outBlock + i*4, palette[index], 4);
+	}
+}
+
+static void getAlphaPalette(int alpha0, int alpha1, int outPalette[8]){
+	outPalette[0] = alpha0;
+	outPalette[1] = alpha1;
+	if (alpha0 > alpha1){
+		for (int i=1;i<7;i++){
+			outPalette[i+1] = ((7-i)*alpha0 + i*alpha1) / 7;
+		}
+	} else {
+		for (int i=1;i<5;i++){
+			outPalette[i+1] = ((5-i)*alpha0 + i*alpha1) / 5;
+		}
+		outPalette[6] = 0;
+		outPalette[7] = 255;
+	}
+}
+
+static void encodeAlphaBlock(const unsigned char * block, unsigned char * out){
+	int alpha0 = 0, alpha1 = 255;
+	for (int i=0;i<16;i++){
+		alpha0 = max(alpha0, (int)block[i*4+3]);
+		alpha1 = min(alpha1, (int)block[i*4+3]);
+	}
+	out[0] = alpha0;
+	out[1] = alpha1;
+	unsigned long long indices = 0;
+	if (alpha0 > alpha1){
+		int palette[8];
+		getAlphaPalette(alpha0, alpha1, palette);
+		for (int i=0;i<16;i++){
+			int bestIndex = 0;
+			int bestDistance = 256;
+			for (int p=0;p<8;p++){
+				int distance = abs(block[i*4+3] - palette[p]);
+				if (distance < bestDistance){
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= (unsigned long long)bestIndex << (i*3);
+		}
+	}
+	for (int i=0;i<6;i++){
+		out[2+i] = (indices >> (i*8)) & 0xff;
+	}
+}
+
+static void decodeAlphaBlock(const unsigned char * in, unsigned char * outBlock){
+	int palette[8];
+	getAlphaPalette(in[0], in[1], palette);
+	unsigned long long indices = 0;
+	for (int i=0;i<6;i++){
+		indices |= (unsigned long long)in[2+i] << (i*8);
+	}
+	for (int i=0;i<16;i++){
+		outBlock[i*4+3] = palette[(indices >> (i*3)) & 7];
+	}
+}
+
+void encodeBC1(const unsigned char * rgba, int width, int height, unsigned char * outBlocks){
+	int blocksX = max(1, (width+3)/4);
+	int blocksY = max(1, (height+3)/4);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int by=0;by<blocksY;by++){
+		unsigned char block[64];
+		for (int bx=0;bx<blocksX;bx++){
+			fetchBlock(rgba, width, height, bx, by, block);
+			encodeColorBlock(block, outBlocks + (by*blocksX + bx)*8);
+		}
+	}
+}
+
+void encodeBC3(const unsigned char * rgba, int width, int height, unsigned char * outBlocks){
+	int blocksX = max(1, (width+3)/4);
+	int blocksY = max(1, (height+3)/4);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int by=0;by<blocksY;by++){
+		unsigned char block[64];
+		for (int bx=0;bx<blocksX;bx++){
+			fetchBlock(rgba, width, height, bx, by, block);
+			unsigned char * out = outBlocks + (by*blocksX + bx)*16;
+			encodeAlphaBlock(block, out);
+			encodeColorBlock(block, out + 8);
+		}
+	}
+}
+
+void decodeBC1(const unsigned char * blocks, int width, int height, unsigned char * outRgba){
+	int blocksX = max(1, (width+3)/4);
+	int blocksY = max(1, (height+3)/4);
+	unsigned char block[64];
+	for (int by=0;by<blocksY;by++){
+		for (int bx=0;bx<blocksX;bx++){
+			decodeColorBlock(blocks + (by*blocksX + bx)*8, false, block);
+			storeBlock(block, width, height, bx, by, outRgba);
+		}
+	}
+}
+
+void decodeBC3(const unsigned char * blocks, int width, int height, unsigned char * outRgba){
+	int blocksX = max(1, (width+3)/4);
+	int blocksY = max(1, (height+3)/4);
+	unsigned char block[64];
+	for (int by=0;by<blocksY;by++){
+		for (int bx=0;bx<blocksX;bx++){
+			const unsigned char * in = blocks + (by*blocksX + bx)*16;
+			decodeColorBlock(in + 8, true, block);
+			decodeAlphaBlock(in, block);
+			storeBlock(block, width, height, bx, by, outRgba);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __BLOCK_COMPRESSION_H
+#define __BLOCK_COMPRESSION_H
+
+// CPU encoder and decoder for BC1 (DXT1) and BC3 (DXT5) compressed blocks.
+// The encoder is meant for offline use (e.g. converting textures to DDS files) and 
+// favours simplicity over quality: the color endpoints are found along the principal 
+// axis of the block colors.
+// Images are RGBA8 with rows of width*4 bytes. Partial blocks at the right and bottom
+// edge are padded by repeating the edge pixels.
+
+// size of the compressed image in bytes
+int getBC1Size(int width, int height);
+int getBC3Size(int width, int height);
+
+// encode an RGBA image (alpha is ignored for BC1)
+void encodeBC1(const unsigned char * rgba, int width, int height, unsigned char * outBlocks);
+void encodeBC3(const unsigned char * rgba, int width, int height, unsigned char * outBlocks);
+
+// decode to an RGBA image
+void decodeBC1(const unsigned char * blocks, int width, int height, unsigned char * outRgba);
+void decodeBC3(const unsigned char * blocks, int width, int height, unsigned char * outRgba);
+
+#endif
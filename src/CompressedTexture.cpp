@@ -0,0 +1,331 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "CompressedTexture.h"
+#include "BlockCompression.h"
+#include "Profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace std;
+
+// DXGI formats of the DDS DX10 header
+enum {
+	DXGI_FORMAT_BC1_UNORM = 71,
+	DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+	DXGI_FORMAT_BC3_UNORM = 77,
+	DXGI_FORMAT_BC3_UNORM_SRGB = 78,
+	DXGI_FORMAT_BC5_UNORM = 83,
+	DXGI_FORMAT_BC7_UNORM = 98,
+	DXGI_FORMAT_BC7_UNORM_SRGB = 99
+};
+
+static const unsigned int DDS_HEADER_SIZE = 124;
+static const unsigned int DDS_PIXELFORMAT_FOURCC = 0x4;
+static const unsigned int DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, 
+	DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+static const unsigned int DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+
+static unsigned int fourCC(const char * code){
+	return code[0] | (code[1] << 8) | (code[2] << 16) | (code[3] << 24);
+}
+
+static unsigned int readUInt32(const unsigned char * bytes, bool swapBytes = false){
+	if (swapBytes){
+		return bytes[3] | (bytes[2] << 8) | (bytes[1] << 16) | ((unsigned int)bytes[0] << 24);
+	}
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static void writeUInt32(unsigned char * bytes, unsigned int value){
+	bytes[0] = value & 0xff;
+	bytes[1] = (value >> 8) & 0xff;
+	bytes[2] = (value >> 16) & 0xff;
+	bytes[3] = (value >> 24) & 0xff;
+}
+
+int getCompressedBlockSize(GLenum internalFormat){
+	switch (internalFormat){
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+			return 8;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+static int getLevelSize(GLenum internalFormat, int width, int height){
+	return max(1, (width+3)/4) * max(1, (height+3)/4) * getCompressedBlockSize(internalFormat);
+}
+
+static bool readFile(const char * path, vector<unsigned char> &outBytes){
+	FILE * file = fopen(path, "rb");
+	if (!file){
+		printf("Texture could not be opened %s\n", path);
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	outBytes.resize(size > 0 ? size : 0);
+	bool ok = size > 0 && fread(&outBytes[0], 1, size, file) == size;
+	fclose(file);
+	return ok;
+}
+
+// set up the levels of a texture whose levels are stored back to back
+static bool setupLevels(CompressedTexture &texture, int width, int height, int levelCount, size_t availableBytes){
+	texture.levels.clear();
+	texture.levelSizes.clear();
+	int offset = 0;
+	for (int i=0;i<levelCount;i++){
+		MipmapLevel level;
+		level.width = max(1, width >> i);
+		level.height = max(1, height >> i);
+		level.offset = offset;
+		int size = getLevelSize(texture.internalFormat, level.width, level.height);
+		if (offset + size > availableBytes){
+			break;
+		}
+		texture.levels.push_back(level);
+		texture.levelSizes.push_back(size);
+		offset += size;
+	}
+	return !texture.levels.empty();
+}
+
+bool loadDDS(const char * path, CompressedTexture &outTexture){
+	vector<unsigned char> file;
+	if (!readFile(path, file)){
+		return false;
+	}
+	if (file.size() < 4 + DDS_HEADER_SIZE || memcmp(&file[0], "DDS ", 4) != 0){
+		printf("Not a correct DDS file %s\n", path);
+		return false;
+	}
+	const unsigned char * header = &file[4];
+	int height = readUInt32(header + 8);
+	int width = readUInt32(header + 12);
+	int levelCount = max(1, (int)readUInt32(header + 24));
+	unsigned int pixelFormatFlags = readUInt32(header + 76);
+	unsigned int code = readUInt32(header + 80);
+	size_t dataOffset = 4 + DDS_HEADER_SIZE;
+
+	outTexture.internalFormat = 0;
+	if ((pixelFormatFlags & DDS_PIXELFORMAT_FOURCC) != 0){
+		if (code == fourCC("DXT1")){
+			outTexture.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		} else if (code == fourCC("DXT5")){
+			outTexture.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		} else if (code == fourCC("ATI2") || code == fourCC("BC5U")){
+			outTexture.internalFormat = GL_COMPRESSED_RG_RGTC2;
+		} else if (code == fourCC("DX10") && file.size() >= dataOffset + 20){
+			unsigned int dxgiFormat = readUInt32(&file[dataOffset]);
+			dataOffset += 20;
+			switch (dxgiFormat){
+				case DXGI_FORMAT_BC1_UNORM: outTexture.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+				case DXGI_FORMAT_BC1_UNORM_SRGB: outTexture.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; break;
+				case DXGI_FORMAT_BC3_UNORM: outTexture.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+				case DXGI_FORMAT_BC3_UNORM_SRGB: outTexture.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+				case DXGI_FORMAT_BC5_UNORM: outTexture.internalFormat = GL_COMPRESSED_RG_RGTC2; break;
+				case DXGI_FORMAT_BC7_UNORM: outTexture.internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+				case DXGI_FORMAT_BC7_UNORM_SRGB: outTexture.internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
+			}
+		}
+	}
+	if (outTexture.internalFormat == 0){
+		printf("Unsupported DDS format %s\n", path);
+		return false;
+	}
+	if (!setupLevels(outTexture, width, height, levelCount, file.size() - dataOffset)){
+		printf("Not a correct DDS file %s\n", path);
+		return false;
+	}
+	outTexture.data.assign(file.begin() + dataOffset, file.end());
+	return true;
+}
+
+bool loadKTX(const char * path, CompressedTexture &outTexture){
+	static const unsigned char identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+	vector<unsigned char> file;
+	if (!readFile(path, file)){
+		return false;
+	}
+	if (file.size() < 64 || memcmp(&file[0], identifier, 12) != 0){
+		printf("Not a correct KTX file %s\n", path);
+		return false;
+	}
+	bool swapBytes = readUInt32(&file[12]) != 0x04030201;
+	outTexture.internalFormat = readUInt32(&file[28], swapBytes);
+	int width = readUInt32(&file[36], swapBytes);
+	int height = max(1u, readUInt32(&file[40], swapBytes));
+	int levelCount = max(1u, readUInt32(&file[56], swapBytes));
+	unsigned int keyValueBytes = readUInt32(&file[60], swapBytes);
+	if (getCompressedBlockSize(outTexture.internalFormat) == 0 || readUInt32(&file[52], swapBytes) > 1){
+		printf("Unsupported KTX format %s\n", path);
+		return false;
+	}
+	// each level is prefixed with its size and padded to 4 bytes
+	size_t position = 64 + keyValueBytes;
+	outTexture.levels.clear();
+	outTexture.levelSizes.clear();
+	outTexture.data.clear();
+	for (int i=0;i<levelCount && position + 4 <= file.size();i++){
+		unsigned int size = readUInt32(&file[position], swapBytes);
+		position += 4;
+		if (position + size > file.size()){
+			break;
+		}
+		MipmapLevel level;
+		level.width = max(1, width >> i);
+		level.height = max(1, height >> i);
+		level.offset = outTexture.data.size();
+		outTexture.levels.push_back(level);
+		outTexture.levelSizes.push_back(size);
+		outTexture.data.insert(outTexture.data.end(), file.begin() + position, file.begin() + position + size);
+		position += (size + 3) & ~3;
+	}
+	if (outTexture.levels.empty()){
+		printf("Not a correct KTX file %s\n", path);
+		return false;
+	}
+	return true;
+}
+
+bool loadCompressedTexture(const char * path, CompressedTexture &outTexture){
+	FILE * file = fopen(path, "rb");
+	if (!file){
+		printf("Texture could not be opened %s\n", path);
+		return false;
+	}
+	unsigned char magic[4] = {0,0,0,0};
+	fread(magic, 1, 4, file);
+	fclose(file);
+	if (memcmp(magic, "DDS ", 4) == 0){
+		return loadDDS(path, outTexture);
+	}
+	return loadKTX(path, outTexture);
+}
+
+bool saveDDS(const char * path, const CompressedTexture &texture){
+	if (texture.levels.empty()){
+		return false;
+	}
+	unsigned char header[4 + DDS_HEADER_SIZE + 20];
+	memset(header, 0, sizeof(header));
+	memcpy(header, "DDS ", 4);
+	unsigned char * dds = header + 4;
+	writeUInt32(dds, DDS_HEADER_SIZE);
+	writeUInt32(dds + 4, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE);
+	writeUInt32(dds + 8, texture.levels[0].height);
+	writeUInt32(dds + 12, texture.levels[0].width);
+	writeUInt32(dds + 16, texture.levelSizes[0]);
+	writeUInt32(dds + 24, texture.levels.size());
+	writeUInt32(dds + 72, 32); // pixel format size
+	writeUInt32(dds + 76, DDS_PIXELFORMAT_FOURCC);
+	writeUInt32(dds + 104, DDSCAPS_TEXTURE | (texture.levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+	size_t headerSize = 4 + DDS_HEADER_SIZE;
+	unsigned int dxgiFormat = 0;
+	switch (texture.internalFormat){
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: writeUInt32(dds + 80, fourCC("DXT1")); break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: writeUInt32(dds + 80, fourCC("DXT5")); break;
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT: dxgiFormat = DXGI_FORMAT_BC1_UNORM_SRGB; break;
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: dxgiFormat = DXGI_FORMAT_BC3_UNORM_SRGB; break;
+		case GL_COMPRESSED_RG_RGTC2: dxgiFormat = DXGI_FORMAT_BC5_UNORM; break;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM: dxgiFormat = DXGI_FORMAT_BC7_UNORM; break;
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM: dxgiFormat = DXGI_FORMAT_BC7_UNORM_SRGB; break;
+		default:
+			printf("Unsupported DDS format\n");
+			return false;
+	}
+	if (dxgiFormat != 0){
+		writeUInt32(dds + 80, fourCC("DX10"));
+		writeUInt32(header + headerSize, dxgiFormat);
+		writeUInt32(header + headerSize + 4, 3); // texture 2D
+		writeUInt32(header + headerSize + 12, 1); // array size
+		headerSize += 20;
+	}
+	FILE * file = fopen(path, "wb");
+	if (!file){
+		printf("DDS file could not be written %s\n", path);
+		return false;
+	}
+	bool ok = fwrite(header, 1, headerSize, file) == headerSize &&
+		fwrite(&texture.data[0], 1, texture.data.size(), file) == texture.data.size();
+	fclose(file);
+	return ok;
+}
+
+void uploadCompressedTexture(const CompressedTexture &texture, GLenum target){
+	PROFILE_GPU_SCOPE("uploadCompressedTexture");
+	PROFILE_BYTES_UPLOADED(texture.data.size());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int i=0;i<texture.levels.size();i++){
+		const MipmapLevel &level = texture.levels[i];
+		glCompressedTexImage2D(target, i, texture.internalFormat, level.width, level.height, 0, 
+			texture.levelSizes[i], texture.getBlocks(i));
+	}
+	glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, texture.levels.size()-1);
+}
+
+void compressMipmaps(const MipmapChain &chain, bool useAlpha, CompressedTexture &outTexture){
+	if (useAlpha){
+		outTexture.internalFormat = chain.srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	} else {
+		outTexture.internalFormat = chain.srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	}
+	outTexture.levels.clear();
+	outTexture.levelSizes.clear();
+	int totalSize = 0;
+	for (int i=0;i<chain.levels.size();i++){
+		MipmapLevel level = chain.levels[i];
+		level.offset = totalSize;
+		int size = getLevelSize(outTexture.internalFormat, level.width, level.height);
+		outTexture.levels.push_back(level);
+		outTexture.levelSizes.push_back(size);
+		totalSize += size;
+	}
+	outTexture.data.resize(totalSize);
+	for (int i=0;i<chain.levels.size();i++){
+		const MipmapLevel &level = chain.levels[i];
+		unsigned char * out = &outTexture.data[outTexture.levels[i].offset];
+		if (useAlpha){
+			encodeBC3(chain.getPixels(i), level.width, level.height, out);
+		} else {
+			encodeBC1(chain.getPixels(i), level.width, level.height, out);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __COMPRESSED_TEXTURE_H
+#define __COMPRESSED_TEXTURE_H
+
+#include <vector>
+#include "Angel.h"
+#include "MipmapGenerator.h"
+
+// Block compressed texture with all mipmap levels (loaded from a DDS or KTX file).
+// Supported formats are BC1 (DXT1), BC3 (DXT5), BC5 (RGTC2 / ATI2) and BC7 (BPTC) 
+// including the sRGB variants of BC1, BC3 and BC7. BC7 requires OpenGL 4.2 or 
+// ARB_texture_compression_bptc.
+//
+// Example usage:
+// CompressedTexture compressed;
+// if (loadCompressedTexture("brick.dds", compressed)){
+//     glBindTexture(GL_TEXTURE_2D, textureId);
+//     uploadCompressedTexture(compressed);
+// }
+struct CompressedTexture {
+	GLenum internalFormat;                 // e.g. GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+	std::vector<MipmapLevel> levels;
+	std::vector<int> levelSizes;           // bytes of each level
+	std::vector<unsigned char> data;
+
+	const unsigned char * getBlocks(int level) const { return &data[levels[level].offset]; }
+};
+
+// bytes per 4x4 block of a compressed format (0 if the format is not supported)
+int getCompressedBlockSize(GLenum internalFormat);
+
+// load a DDS (including the DX10 header) or KTX 1.1 file
+bool loadDDS(const char * path, CompressedTexture &outTexture);
+bool loadKTX(const char * path, CompressedTexture &outTexture);
+// detect the container from the file identifier
+bool loadCompressedTexture(const char * path, CompressedTexture &outTexture);
+
+// write a DDS file (DX10 header is used for BC5 and BC7)
+bool saveDDS(const char * path, const CompressedTexture &texture);
+
+// upload all levels with glCompressedTexImage2D to the currently bound texture
+void uploadCompressedTexture(const CompressedTexture &texture, GLenum target = GL_TEXTURE_2D);
+
+// compress all levels of a mipmap chain to BC1 (useAlpha = false) or BC3 (see BlockCompression.h)
+void compressMipmaps(const MipmapChain &chain, bool useAlpha, CompressedTexture &outTexture);
+
+#endif
@@ -31,30 +31,91 @@
 using namespace std;
 
 FrameBufferObject::FrameBufferObject(Texture *texture, bool useDepthBuffer)
-:texture(texture){
-    
-    
+:width(texture->getWidth()), height(texture->getHeight()), samples(0), depthRenderbufferId(0), depthTextureId(0){
+    textures.push_back(texture);
+    init(useDepthBuffer ? FRAMEBUFFER_DEPTH_RENDERBUFFER : FRAMEBUFFER_DEPTH_NONE);
+}
+
+FrameBufferObject::FrameBufferObject(const std::vector<Texture*> &textures, FrameBufferDepth depth)
+:textures(textures), width(0), height(0), samples(0), framebufferid(0), 
+depthRenderbufferId(0), depthTextureId(0){
+    if (textures.empty()){
+        cerr << "FrameBufferObject needs at least one texture" << endl;
+        return;
+    }
+    width = textures[0]->getWidth();
+    height = textures[0]->getHeight();
+    init(depth);
+}
+
+FrameBufferObject::FrameBufferObject(GLuint width, GLuint height, int samples, int colorAttachments, bool floatingPoint, bool useDepthBuffer)
+:width(width), height(height), samples(samples), depthRenderbufferId(0), depthTextureId(0){
+    // create a multisampled renderbuffer for each color attachment
+    for (int i=0;i<colorAttachments;i++){
+        GLuint renderbufferId;
+        glGenRenderbuffers(1, &renderbufferId);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbufferId);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, floatingPoint?GL_RGBA32F:GL_RGBA8, width, height);
+        colorRenderbufferIds.push_back(renderbufferId);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    init(useDepthBuffer ? FRAMEBUFFER_DEPTH_RENDERBUFFER : FRAMEBUFFER_DEPTH_NONE);
+}
+
+void FrameBufferObject::init(FrameBufferDepth depth){
     // create a renderbuffer object to store depth info
-    GLuint rboId;
-    if (useDepthBuffer){
-        glGenRenderbuffers(1, &rboId);
-        glBindRenderbuffer(GL_RENDERBUFFER, rboId);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT,
-                          texture->getWidth(), texture->getHeight());
+    if (depth == FRAMEBUFFER_DEPTH_RENDERBUFFER){
+        glGenRenderbuffers(1, &depthRenderbufferId);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbufferId);
+        if (samples > 0){
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, width, height);
+        } else {
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        }
         glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    } else if (depth == FRAMEBUFFER_DEPTH_TEXTURE){
+        // create a depth texture which can be sampled after rendering (e.g. shadow maps)
+        glGenTextures(1, &depthTextureId);
+        glBindTexture(GL_TEXTURE_2D, depthTextureId);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
     }
     
     // create a framebuffer object
     glGenFramebuffers(1, &framebufferid);
     bind();
-    // attach the texture to FBO color attachment point
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                           GL_TEXTURE_2D, texture->getTextureId(), 0);
+    // attach the textures (or renderbuffers) to FBO color attachment points
+    vector<GLenum> drawBuffers;
+    for (int i=0;i<textures.size();i++){
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i,
+                               GL_TEXTURE_2D, textures[i]->getTextureId(), 0);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+    for (int i=0;i<colorRenderbufferIds.size();i++){
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i,
+                                  GL_RENDERBUFFER, colorRenderbufferIds[i]);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+    // fragment shader output n is written to color attachment n
+    if (drawBuffers.empty()){
+        // depth only (strict drivers require both the draw and read buffer to be GL_NONE)
+        drawBuffers.push_back(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    glDrawBuffers(drawBuffers.size(), &drawBuffers[0]);
     
     // attach the renderbuffer to depth attachment point
-    if (useDepthBuffer){
+    if (depthRenderbufferId != 0){
         glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-                              GL_RENDERBUFFER, rboId);
+                              GL_RENDERBUFFER, depthRenderbufferId);
+    }
+    if (depthTextureId != 0){
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                               GL_TEXTURE_2D, depthTextureId, 0);
     }
     checkFramebufferStatusOk();
 }
@@ -62,6 +123,15 @@ FrameBufferObject::FrameBufferObject(Texture *texture, bool useDepthBuffer)
 
 FrameBufferObject::~FrameBufferObject(){
     glDeleteFramebuffers(1, &framebufferid);
+    if (depthRenderbufferId != 0){
+        glDeleteRenderbuffers(1, &depthRenderbufferId);
+    }
+    if (depthTextureId != 0){
+        glDeleteTextures(1, &depthTextureId);
+    }
+    if (colorRenderbufferIds.size() > 0){
+        glDeleteRenderbuffers(colorRenderbufferIds.size(), &colorRenderbufferIds[0]);
+    }
 }
 
 void FrameBufferObject::bind(){
@@ -72,6 +142,40 @@ void FrameBufferObject::unbind(){
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void FrameBufferObject::resolve(FrameBufferObject *target, bool resolveDepth){
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferid);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->framebufferid : 0);
+    int targetWidth = target ? target->width : width;
+    int targetHeight = target ? target->height : height;
+    if (target == NULL){
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    } else {
+        // blit one color attachment at a time
+        int count = min(getColorAttachmentCount(), target->getColorAttachmentCount());
+        for (int i=0;i<count;i++){
+            GLenum attachment = GL_COLOR_ATTACHMENT0 + i;
+            glReadBuffer(attachment);
+            glDrawBuffers(1, &attachment);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+        // restore draw buffers of target
+        vector<GLenum> drawBuffers;
+        for (int i=0;i<target->getColorAttachmentCount();i++){
+            drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+        }
+        if (drawBuffers.empty()){
+            drawBuffers.push_back(GL_NONE);
+        }
+        glDrawBuffers(drawBuffers.size(), &drawBuffers[0]);
+    }
+    if (resolveDepth){
+        glBlitFramebuffer(0, 0, width, height, 0, 0, targetWidth, targetHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+    glReadBuffer(getColorAttachmentCount() > 0 ? GL_COLOR_ATTACHMENT0 : GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 void FrameBufferObject::checkFramebufferStatusOk(){
     GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     switch (status){
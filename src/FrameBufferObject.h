@@ -28,6 +28,7 @@
 #define __VertexBlending__FrameBufferObject__
 
 #include <iostream>
+#include <vector>
 #include "Angel.h"
 
 #include "Texture.h"
@@ -46,18 +47,55 @@
 // fbo->unbind();
 // // offscreenTexture now contains the rendering
 // 
+// Multiple render targets (fragment shader output n is written to textures[n]):
+// FrameBufferObject *gbuffer = new FrameBufferObject(textures, FRAMEBUFFER_DEPTH_TEXTURE);
+//
+// Multisampling (render to msaaFbo, then resolve into a texture framebuffer object):
+// FrameBufferObject *msaaFbo = new FrameBufferObject(WINDOW_WIDTH, WINDOW_HEIGHT, 4);
+// msaaFbo->resolve(fbo);
+// 
+
+enum FrameBufferDepth {
+    FRAMEBUFFER_DEPTH_NONE,
+    FRAMEBUFFER_DEPTH_RENDERBUFFER,
+    // depth is stored in a texture (see getDepthTextureId())
+    FRAMEBUFFER_DEPTH_TEXTURE
+};
+
 class FrameBufferObject {
 public:
     FrameBufferObject(Texture *texture, bool useDepthBuffer = true);
+    // attach the textures to GL_COLOR_ATTACHMENT0 ... GL_COLOR_ATTACHMENTn (all textures must have same size)
+    FrameBufferObject(const std::vector<Texture*> &textures, FrameBufferDepth depth = FRAMEBUFFER_DEPTH_RENDERBUFFER);
+    // multisampled framebuffer object using renderbuffers. Use resolve() to get the result
+    FrameBufferObject(GLuint width, GLuint height, int samples, int colorAttachments = 1, bool floatingPoint = false, bool useDepthBuffer = true);
     ~FrameBufferObject();
     // bind the framebufferobject as current
     void bind();
     // releases the framebuffer object (this is not needed if another framebuffer object is bound instead)
     void unbind();
+    // copies (and resolves multisampling) the color attachments into the target framebuffer object
+    // if target is NULL color attachment 0 is copied to the default framebuffer
+    void resolve(FrameBufferObject *target, bool resolveDepth = false);
+    // returns the color texture (NULL if multisampled)
+    Texture *getTexture(int index = 0) { return index < textures.size() ? textures[index] : NULL; }
+    int getColorAttachmentCount() { return textures.size() + colorRenderbufferIds.size(); }
+    GLuint getDepthTextureId() { return depthTextureId; }
+    GLuint getFramebufferId() { return framebufferid; }
+    GLuint getWidth() { return width; }
+    GLuint getHeight() { return height; }
+    int getSamples() { return samples; }
 private:
+    void init(FrameBufferDepth depth);
     void checkFramebufferStatusOk();
-    Texture *texture;
+    std::vector<Texture*> textures;
+    std::vector<GLuint> colorRenderbufferIds;
+    GLuint width;
+    GLuint height;
+    int samples;
     GLuint framebufferid;
+    GLuint depthRenderbufferId;
+    GLuint depthTextureId;
 };
 
 
@@ -0,0 +1,209 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "HeadlessContext.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+using namespace std;
+
+namespace {
+	EGLDisplay getDisplay(){
+		// prefer a display without window system (works without X11/Wayland)
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = 
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay != NULL){
+			EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+			EGLint major, minor;
+			if (display != EGL_NO_DISPLAY && eglInitialize(display, &major, &minor)){
+				return display;
+			}
+		}
+		EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		EGLint major, minor;
+		if (display != EGL_NO_DISPLAY && eglInitialize(display, &major, &minor)){
+			return display;
+		}
+		return EGL_NO_DISPLAY;
+	}
+
+	bool readPPM(const string &filename, int &outWidth, int &outHeight, vector<unsigned char> &outPixels){
+		FILE *file = fopen(filename.c_str(), "rb");
+		if (file == NULL){
+			return false;
+		}
+		int maxValue;
+		bool ok = fscanf(file, "P6 %d %d %d", &outWidth, &outHeight, &maxValue) == 3 && maxValue == 255 && fgetc(file) != EOF;
+		if (ok){
+			outPixels.resize(outWidth * outHeight * 3);
+			ok = fread(&outPixels[0], 1, outPixels.size(), file) == outPixels.size();
+		}
+		fclose(file);
+		return ok;
+	}
+}
+
+HeadlessContext::HeadlessContext(int width, int height, int majorVersion, int minorVersion)
+	:width(width), height(height), display(EGL_NO_DISPLAY), surface(EGL_NO_SURFACE), context(NULL) {
+	display = getDisplay();
+	if (display == EGL_NO_DISPLAY){
+		cerr << "HeadlessContext: Cannot initialize EGL display" << endl;
+		return;
+	}
+	EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0){
+		cerr << "HeadlessContext: No pbuffer config found" << endl;
+		return;
+	}
+	EGLint surfaceAttributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+	surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+	if (surface == EGL_NO_SURFACE){
+		cerr << "HeadlessContext: Cannot create pbuffer (error 0x" << hex << eglGetError() << dec << ")" << endl;
+		return;
+	}
+	eglBindAPI(EGL_OPENGL_API);
+	EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+		EGL_CONTEXT_MINOR_VERSION, minorVersion,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE, EGL_TRUE,
+		EGL_NONE
+	};
+	EGLContext eglContext = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (eglContext == EGL_NO_CONTEXT){
+		cerr << "HeadlessContext: Cannot create OpenGL " << majorVersion << "." << minorVersion << " context (error 0x" << hex << eglGetError() << dec << ")" << endl;
+		return;
+	}
+	context = eglContext;
+	makeCurrent();
+#ifdef GLEW_VERSION
+	glewExperimental = GL_TRUE;
+	GLenum glewInitResult = glewInit();
+	if (glewInitResult != GLEW_OK) {
+		// GLEW built for GLX may report an error even though the functions are loaded
+		cerr << "HeadlessContext: " << glewGetErrorString(glewInitResult) << endl;
+	}
+	glGetError(); // glewInit may cause GL_INVALID_ENUM in core profile
+#endif
+	glViewport(0, 0, width, height);
+}
+
+HeadlessContext::~HeadlessContext(){
+	if (display == EGL_NO_DISPLAY){
+		return;
+	}
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (context != NULL){
+		eglDestroyContext(display, context);
+	}
+	if (surface != EGL_NO_SURFACE){
+		eglDestroySurface(display, surface);
+	}
+	eglTerminate(display);
+}
+
+void HeadlessContext::makeCurrent(){
+	if (context != NULL){
+		eglMakeCurrent(display, surface, surface, context);
+	}
+}
+
+std::string HeadlessContext::getRendererString(){
+	const char *renderer = (const char *)glGetString(GL_RENDERER);
+	const char *version = (const char *)glGetString(GL_VERSION);
+	return string(renderer ? renderer : "") + " " + (version ? version : "");
+}
+
+void HeadlessContext::readPixels(std::vector<unsigned char> &outPixels){
+	GLint readFramebuffer, packAlignment;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+	glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	vector<unsigned char> pixels(width * height * 3);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+	glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+
+	// OpenGL returns the bottom row first
+	int rowSize = width * 3;
+	outPixels.resize(pixels.size());
+	for (int y = 0; y < height; y++){
+		memcpy(&outPixels[y * rowSize], &pixels[(height - 1 - y) * rowSize], rowSize);
+	}
+}
+
+bool HeadlessContext::saveImage(const std::string &filename){
+	vector<unsigned char> pixels;
+	readPixels(pixels);
+	FILE *file = fopen(filename.c_str(), "wb");
+	if (file == NULL){
+		cerr << "Cannot write " << filename << endl;
+		return false;
+	}
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	fwrite(&pixels[0], 1, pixels.size(), file);
+	fclose(file);
+	return true;
+}
+
+int HeadlessContext::compareImage(const std::string &filename, int tolerance){
+	int imageWidth, imageHeight;
+	vector<unsigned char> expected;
+	if (!readPPM(filename, imageWidth, imageHeight, expected)){
+		cerr << "Cannot read " << filename << endl;
+		return -1;
+	}
+	if (imageWidth != width || imageHeight != height){
+		cerr << filename << " has size " << imageWidth << "x" << imageHeight << " (expected " << width << "x" << height << ")" << endl;
+		return -1;
+	}
+	vector<unsigned char> pixels;
+	readPixels(pixels);
+	int differentPixels = 0;
+	for (int i = 0; i < width * height; i++){
+		for (int c = 0; c < 3; c++){
+			if (abs(pixels[i * 3 + c] - expected[i * 3 + c]) > tolerance){
+				differentPixels++;
+				break;
+			}
+		}
+	}
+	return differentPixels;
+}
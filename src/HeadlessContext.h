@@ -0,0 +1,75 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __HEADLESS_CONTEXT_H
+#define __HEADLESS_CONTEXT_H
+
+#include <string>
+#include <vector>
+#include "Angel.h"
+
+// OpenGL context without a window (using EGL), e.g. for running the library on a build server 
+// using Mesa's software rasterizer (llvmpipe). The context has an offscreen (pbuffer) default 
+// framebuffer of the given size.
+// The readback methods can be used to compare the rendered image with a golden image 
+// (images are stored as binary PPM files).
+// Example usage:
+//
+// HeadlessContext context(256, 256);
+// if (!context.isValid()){
+//     return 1;
+// }
+// renderScene();
+// int errors = context.compareImage("golden/scene.ppm", 2);
+//
+// On Linux the software rasterizer can be forced using the environment variable LIBGL_ALWAYS_SOFTWARE=1
+class HeadlessContext {
+public:
+	HeadlessContext(int width, int height, int majorVersion = 3, int minorVersion = 2);
+	~HeadlessContext();
+	// returns false if the context could not be created
+	bool isValid() { return context != NULL; }
+	void makeCurrent();
+	int getWidth() { return width; }
+	int getHeight() { return height; }
+	// returns the renderer and version string (e.g. "llvmpipe (LLVM 15.0.6, 256 bits) 4.5 (Core Profile) Mesa 22.3.6")
+	std::string getRendererString();
+	// reads the RGB pixels of the default framebuffer (top row first)
+	void readPixels(std::vector<unsigned char> &outPixels);
+	// saves the default framebuffer as a binary PPM image
+	bool saveImage(const std::string &filename);
+	// compares the default framebuffer with a PPM image. Returns the number of pixels where a color 
+	// component differs by more than the tolerance (or -1 if the image could not be read or has another size)
+	int compareImage(const std::string &filename, int tolerance = 0);
+private:
+	int width;
+	int height;
+	void *display; // EGLDisplay
+	void *surface; // EGLSurface
+	void *context; // EGLContext
+};
+
+#endif
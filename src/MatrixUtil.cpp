@@ -0,0 +1,106 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "MatrixUtil.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+bool invert(const mat4 &m, mat4 &outInverse){
+	// Gauss-Jordan elimination with partial pivoting on [m | I]
+	float a[4][8];
+	for (int i=0;i<4;i++){
+		for (int j=0;j<4;j++){
+			a[i][j] = m[i][j];
+			a[i][j+4] = i == j ? 1.0f : 0.0f;
+		}
+	}
+	for (int column=0;column<4;column++){
+		int pivot = column;
+		for (int row=column+1;row<4;row++){
+			if (fabs(a[row][column]) > fabs(a[pivot][column])){
+				pivot = row;
+			}
+		}
+		if (fabs(a[pivot][column]) < 1e-12f){
+			return false;
+		}
+		if (pivot != column){
+			for (int j=0;j<8;j++){
+				swap(a[pivot][j], a[column][j]);
+			}
+		}
+		float scale = 1.0f / a[column][column];
+		for (int j=0;j<8;j++){
+			a[column][j] *= scale;
+		}
+		for (int row=0;row<4;row++){
+			if (row == column){
+				continue;
+			}
+			float factor = a[row][column];
+			for (int j=0;j<8;j++){
+				a[row][j] -= factor * a[column][j];
+			}
+		}
+	}
+	for (int i=0;i<4;i++){
+		for (int j=0;j<4;j++){
+			outInverse[i][j] = a[i][j+4];
+		}
+	}
+	return true;
+}
+
+vec3 unProject(const vec3 &window, const mat4 &projection, const mat4 &modelView, const vec4 &viewport){
+	mat4 inverse;
+	if (!invert(projection * modelView, inverse)){
+		return vec3(0,0,0);
+	}
+	// window coordinates to normalized device coordinates
+	vec4 ndc((window.x - viewport.x) / viewport.z * 2.0f - 1.0f,
+		(window.y - viewport.y) / viewport.w * 2.0f - 1.0f,
+		window.z * 2.0f - 1.0f,
+		1.0f);
+	vec4 object = inverse * ndc;
+	if (object.w == 0){
+		return vec3(0,0,0);
+	}
+	return vec3(object.x / object.w, object.y / object.w, object.z / object.w);
+}
+
+vec3 project(const vec3 &object, const mat4 &projection, const mat4 &modelView, const vec4 &viewport){
+	vec4 clip = projection * (modelView * vec4(object, 1.0f));
+	if (clip.w == 0){
+		return vec3(0,0,0);
+	}
+	vec3 ndc(clip.x / clip.w, clip.y / clip.w, clip.z / clip.w);
+	return vec3(viewport.x + (ndc.x + 1.0f) * 0.5f * viewport.z,
+		viewport.y + (ndc.y + 1.0f) * 0.5f * viewport.w,
+		(ndc.z + 1.0f) * 0.5f);
+}
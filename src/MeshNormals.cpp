@@ -0,0 +1,217 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "MeshNormals.h"
+
+#include <cmath>
+#include <map>
+
+using namespace std;
+
+// vertex to triangle adjacency in compressed row storage
+static void buildAdjacency(vector<int> const &indices, int vertexCount, vector<int> &outOffset, vector<int> &outTriangles){
+	outOffset.assign(vertexCount+1, 0);
+	for (int i=0;i<indices.size();i++){
+		outOffset[indices[i]+1]++;
+	}
+	for (int i=0;i<vertexCount;i++){
+		outOffset[i+1] += outOffset[i];
+	}
+	outTriangles.resize(indices.size());
+	vector<int> fill(outOffset.begin(), outOffset.end()-1);
+	for (int i=0;i<indices.size();i++){
+		outTriangles[fill[indices[i]]++] = i/3;
+	}
+}
+
+// lexicographic order of positions (used for welding vertices with the same position)
+struct PositionKey {
+	vec3 position;
+
+	PositionKey(vec3 position):position(position){}
+
+	bool operator<(const PositionKey& Rhs) const {
+		return position.x < Rhs.position.x || 
+			(position.x == Rhs.position.x && position.y < Rhs.position.y) ||
+			(position.x == Rhs.position.x && position.y == Rhs.position.y && position.z < Rhs.position.z);
+	}
+};
+
+// maps each vertex to the first vertex with the same position
+static void weldPositions(vector<vec3> const &positions, vector<int> &outWelded){
+	outWelded.resize(positions.size());
+	map<PositionKey,int> firstVertex;
+	for (int i=0;i<positions.size();i++){
+		map<PositionKey,int>::iterator found = firstVertex.insert(make_pair(PositionKey(positions[i]), i)).first;
+		outWelded[i] = found->second;
+	}
+}
+
+void generateNormals(vector<int> &indices, vector<vec3> &positions, vector<vec3> &outNormals, vector<vec2> &uvs, float creaseAngle){
+	int triangleCount = indices.size() / 3;
+	int vertexCount = positions.size();
+	bool hasUvs = uvs.size() == positions.size();
+
+	// the length of the cross product is twice the triangle area
+	vector<vec3> faceNormals(triangleCount);
+	vector<vec3> unitFaceNormals(triangleCount);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int i=0;i<triangleCount;i++){
+		vec3 p0 = positions[indices[i*3]];
+		vec3 p1 = positions[indices[i*3+1]];
+		vec3 p2 = positions[indices[i*3+2]];
+		vec3 normal = cross(p1 - p0, p2 - p0);
+		float normalLength = length(normal);
+		faceNormals[i] = normal;
+		unitFaceNormals[i] = normalLength > 0 ? normal / normalLength : vec3(0,0,0);
+	}
+
+	// smooth across vertices split by the obj loader (e.g. at uv seams) by using the adjacency
+	// of the welded positions. The split vertices are kept for the output
+	vector<int> welded;
+	weldPositions(positions, welded);
+	vector<int> weldedIndices(indices.size());
+	for (int i=0;i<indices.size();i++){
+		weldedIndices[i] = welded[indices[i]];
+	}
+	vector<int> adjacencyOffset;
+	vector<int> adjacency;
+	buildAdjacency(weldedIndices, vertexCount, adjacencyOffset, adjacency);
+
+	// normal of each triangle corner using only the neighbours within the crease angle
+	float cosCrease = cos(creaseAngle * 3.14159265f / 180.0f);
+	vector<vec3> cornerNormals(triangleCount*3);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int i=0;i<triangleCount;i++){
+		for (int j=0;j<3;j++){
+			int vertex = weldedIndices[i*3+j];
+			vec3 normal(0,0,0);
+			for (int k=adjacencyOffset[vertex];k<adjacencyOffset[vertex+1];k++){
+				int triangle = adjacency[k];
+				if (dot(unitFaceNormals[i], unitFaceNormals[triangle]) >= cosCrease){
+					normal += faceNormals[triangle];
+				}
+			}
+			float normalLength = length(normal);
+			cornerNormals[i*3+j] = normalLength > 0 ? normal / normalLength : unitFaceNormals[i];
+		}
+	}
+
+	// assign normals to vertices, duplicate vertices having more than one normal
+	outNormals.assign(vertexCount, vec3(0,0,0));
+	vector<bool> assigned(vertexCount, false);
+	vector<int> nextCopy(vertexCount, -1); // linked list of copies of the same vertex
+	for (int i=0;i<triangleCount*3;i++){
+		int vertex = indices[i];
+		vec3 normal = cornerNormals[i];
+		if (!assigned[vertex]){
+			assigned[vertex] = true;
+			outNormals[vertex] = normal;
+			continue;
+		}
+		int copy = vertex;
+		int last = vertex;
+		while (copy != -1 && dot(outNormals[copy], normal) < 0.9999f){
+			last = copy;
+			copy = nextCopy[copy];
+		}
+		if (copy == -1){
+			copy = positions.size();
+			positions.push_back(positions[vertex]);
+			if (hasUvs){
+				uvs.push_back(uvs[vertex]);
+			}
+			outNormals.push_back(normal);
+			nextCopy.push_back(-1);
+			nextCopy[last] = copy;
+		}
+		indices[i] = copy;
+	}
+}
+
+bool generateTangents(vector<int> const &indices, vector<vec3> const &positions, vector<vec3> const &normals, vector<vec2> const &uvs, vector<vec4> &outTangents){
+	int triangleCount = indices.size() / 3;
+	int vertexCount = positions.size();
+	if (uvs.size() != vertexCount || normals.size() != vertexCount){
+		return false;
+	}
+
+	vector<vec3> faceTangents(triangleCount);
+	vector<vec3> faceBitangents(triangleCount);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int i=0;i<triangleCount;i++){
+		int i0 = indices[i*3];
+		int i1 = indices[i*3+1];
+		int i2 = indices[i*3+2];
+		vec3 edge1 = positions[i1] - positions[i0];
+		vec3 edge2 = positions[i2] - positions[i0];
+		vec2 deltaUv1 = uvs[i1] - uvs[i0];
+		vec2 deltaUv2 = uvs[i2] - uvs[i0];
+		float determinant = deltaUv1.x * deltaUv2.y - deltaUv2.x * deltaUv1.y;
+		if (determinant == 0){
+			faceTangents[i] = vec3(0,0,0);
+			faceBitangents[i] = vec3(0,0,0);
+			continue;
+		}
+		float r = 1.0f / determinant;
+		faceTangents[i] = (edge1 * deltaUv2.y - edge2 * deltaUv1.y) * r;
+		faceBitangents[i] = (edge2 * deltaUv1.x - edge1 * deltaUv2.x) * r;
+	}
+
+	vector<int> adjacencyOffset;
+	vector<int> adjacency;
+	buildAdjacency(indices, vertexCount, adjacencyOffset, adjacency);
+
+	outTangents.resize(vertexCount);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int i=0;i<vertexCount;i++){
+		vec3 tangent(0,0,0);
+		vec3 bitangent(0,0,0);
+		for (int k=adjacencyOffset[i];k<adjacencyOffset[i+1];k++){
+			tangent += faceTangents[adjacency[k]];
+			bitangent += faceBitangents[adjacency[k]];
+		}
+		vec3 normal = normals[i];
+		// Gram-Schmidt orthogonalize
+		tangent = tangent - normal * dot(normal, tangent);
+		float tangentLength = length(tangent);
+		if (tangentLength == 0){
+			outTangents[i] = vec4(0,0,0,1);
+			continue;
+		}
+		tangent = tangent / tangentLength;
+		float handedness = dot(cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+		outTangents[i] = vec4(tangent, handedness);
+	}
+	return true;
+}
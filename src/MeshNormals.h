@@ -0,0 +1,56 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __MESH_NORMALS_H
+#define __MESH_NORMALS_H
+
+#include <vector>
+#include "Angel.h"
+
+// Generates area weighted smooth normals for a triangle mesh (e.g. an OBJ file without vn).
+// Vertices with the same position are smoothed together, so there are no seams where
+// the vertices are split (e.g. at uv seams).
+// Triangles meeting at an angle larger than creaseAngle (in degrees) are not smoothed; 
+// vertices on such a crease are duplicated (positions and uvs are appended to), so the 
+// index values change but the number and order of indices does not (submeshes stay valid).
+// outNormals is resized to the (new) number of positions.
+// The loops are parallelized with OpenMP when compiled with OpenMP support.
+void generateNormals(std::vector<int> &indices, 
+	std::vector<vec3> &positions, 
+	std::vector<vec3> &outNormals, 
+	std::vector<vec2> &uvs,
+	float creaseAngle = 60.0f);
+
+// Generates per vertex tangents from the uv coordinates (based on "Computing Tangent Space
+// Basis Vectors for an Arbitrary Mesh" by Eric Lengyel). The tangents are orthogonal to
+// the normals and w is the handedness, so bitangent = cross(normal, tangent.xyz) * tangent.w
+// Returns false if the mesh has no uvs or normals for each position.
+bool generateTangents(std::vector<int> const &indices, 
+	std::vector<vec3> const &positions, 
+	std::vector<vec3> const &normals, 
+	std::vector<vec2> const &uvs,
+	std::vector<vec4> &outTangents);
+
+#endif
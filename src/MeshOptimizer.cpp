@@ -0,0 +1,219 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+int computeCacheMisses(vector<int> const &indices, int vertexCount, int cacheSize, int firstIndex, int indexCount){
+	if (indexCount < 0){
+		indexCount = indices.size() - firstIndex;
+	}
+	// cacheTimestamp holds the miss counter value when the vertex was inserted into the FIFO
+	vector<int> cacheTimestamp(vertexCount, -cacheSize-1);
+	int misses = 0;
+	for (int i=firstIndex;i<firstIndex+indexCount;i++){
+		int vertex = indices[i];
+		if (misses - cacheTimestamp[vertex] > cacheSize){
+			cacheTimestamp[vertex] = misses;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+// find the next fanning vertex - returns -1 when all triangles are emitted
+static int getNextVertex(vector<int> const &candidates, vector<int> const &liveTriangles,
+	vector<int> const &cacheTime, int time, int cacheSize,
+	vector<int> &deadEndStack, vector<int> const &rangeVertices, int &cursor){
+	int bestVertex = -1;
+	int bestPriority = -1;
+	for (int i=0;i<candidates.size();i++){
+		int vertex = candidates[i];
+		if (liveTriangles[vertex] > 0){
+			int priority = 0;
+			// vertices still in the cache after emitting all its triangles are preferred
+			if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize){
+				priority = time - cacheTime[vertex];
+			}
+			if (priority > bestPriority){
+				bestPriority = priority;
+				bestVertex = vertex;
+			}
+		}
+	}
+	if (bestVertex != -1){
+		return bestVertex;
+	}
+	// dead end - use a recently used vertex
+	while (!deadEndStack.empty()){
+		int vertex = deadEndStack.back();
+		deadEndStack.pop_back();
+		if (liveTriangles[vertex] > 0){
+			return vertex;
+		}
+	}
+	// otherwise use the next vertex in input order
+	while (cursor < rangeVertices.size()){
+		int vertex = rangeVertices[cursor++];
+		if (liveTriangles[vertex] > 0){
+			return vertex;
+		}
+	}
+	return -1;
+}
+
+void optimizeVertexCache(vector<int> &indices, int vertexCount, int cacheSize, int firstIndex, int indexCount){
+	if (indexCount < 0){
+		indexCount = indices.size() - firstIndex;
+	}
+	int triangleCount = indexCount / 3;
+	if (triangleCount == 0){
+		return;
+	}
+	int const *triangles = &(indices[firstIndex]);
+
+	// build vertex-triangle adjacency (compressed row storage)
+	vector<int> liveTriangles(vertexCount, 0);
+	for (int i=0;i<triangleCount*3;i++){
+		liveTriangles[triangles[i]]++;
+	}
+	vector<int> adjacencyOffset(vertexCount+1, 0);
+	vector<int> rangeVertices; // vertices used by the range in input order
+	for (int i=0;i<vertexCount;i++){
+		adjacencyOffset[i+1] = adjacencyOffset[i] + liveTriangles[i];
+	}
+	vector<int> adjacency(adjacencyOffset[vertexCount]);
+	vector<int> fill(adjacencyOffset.begin(), adjacencyOffset.end()-1);
+	for (int i=0;i<triangleCount*3;i++){
+		int vertex = triangles[i];
+		if (fill[vertex] == adjacencyOffset[vertex]){
+			rangeVertices.push_back(vertex);
+		}
+		adjacency[fill[vertex]++] = i/3;
+	}
+
+	vector<int> cacheTime(vertexCount, 0);
+	vector<bool> emitted(triangleCount, false);
+	vector<int> deadEndStack;
+	vector<int> candidates;
+	vector<int> output;
+	output.reserve(triangleCount*3);
+
+	int fanningVertex = triangles[0];
+	int time = cacheSize + 1;
+	int cursor = 0;
+	while (fanningVertex >= 0){
+		candidates.clear();
+		for (int i=adjacencyOffset[fanningVertex];i<adjacencyOffset[fanningVertex+1];i++){
+			int triangle = adjacency[i];
+			if (emitted[triangle]){
+				continue;
+			}
+			for (int j=0;j<3;j++){
+				int vertex = triangles[triangle*3+j];
+				output.push_back(vertex);
+				deadEndStack.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (time - cacheTime[vertex] > cacheSize){
+					cacheTime[vertex] = time;
+					time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+		fanningVertex = getNextVertex(candidates, liveTriangles, cacheTime, time, cacheSize, deadEndStack, rangeVertices, cursor);
+	}
+	copy(output.begin(), output.end(), indices.begin() + firstIndex);
+}
+
+template <class T>
+void reorderVertices(vector<T> &vertices, vector<int> const &remap, int newSize){
+	vector<T> reordered(newSize);
+	for (int i=0;i<remap.size();i++){
+		reordered[remap[i]] = vertices[i];
+	}
+	vertices.swap(reordered);
+}
+
+void optimizeVertexFetch(vector<int> &indices, vector<vec3> &positions, vector<vec3> &normals, vector<vec2> &uvs){
+	int vertexCount = positions.size();
+	vector<int> remap(vertexCount, -1);
+	int next = 0;
+	for (int i=0;i<indices.size();i++){
+		int &index = indices[i];
+		if (remap[index] == -1){
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+	// keep unreferenced vertices at the end
+	for (int i=0;i<vertexCount;i++){
+		if (remap[i] == -1){
+			remap[i] = next++;
+		}
+	}
+	reorderVertices(positions, remap, vertexCount);
+	if (normals.size() == vertexCount){
+		reorderVertices(normals, remap, vertexCount);
+	}
+	if (uvs.size() == vertexCount){
+		reorderVertices(uvs, remap, vertexCount);
+	}
+}
+
+MeshOptimizationStatistics optimizeMesh(vector<int> &indices, 
+	vector<vec3> &positions, 
+	vector<vec3> &normals, 
+	vector<vec2> &uvs,
+	vector<ObjSubmesh> const &submeshes,
+	int cacheSize){
+	MeshOptimizationStatistics stats;
+	int vertexCount = positions.size();
+	int triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0){
+		stats.acmrBefore = stats.atvrBefore = stats.acmrAfter = stats.atvrAfter = 0;
+		return stats;
+	}
+	int missesBefore = computeCacheMisses(indices, vertexCount, cacheSize);
+	if (submeshes.empty()){
+		optimizeVertexCache(indices, vertexCount, cacheSize);
+	} else {
+		for (int i=0;i<submeshes.size();i++){
+			optimizeVertexCache(indices, vertexCount, cacheSize, submeshes[i].firstIndex, submeshes[i].indexCount);
+		}
+	}
+	optimizeVertexFetch(indices, positions, normals, uvs);
+	int missesAfter = computeCacheMisses(indices, vertexCount, cacheSize);
+
+	stats.acmrBefore = missesBefore / float(triangleCount);
+	stats.atvrBefore = missesBefore / float(vertexCount);
+	stats.acmrAfter = missesAfter / float(triangleCount);
+	stats.atvrAfter = missesAfter / float(vertexCount);
+	return stats;
+}
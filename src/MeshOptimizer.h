@@ -0,0 +1,74 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __MESH_OPTIMIZER_H
+#define __MESH_OPTIMIZER_H
+
+#include <vector>
+#include "Angel.h"
+#include "ObjLoader.h"
+
+// Average cache miss ratio (transformed vertices per triangle) and average transformed 
+// vertex ratio (transformed vertices per vertex) before and after optimization.
+// ACMR is between 0.5 (optimal) and 3.0, ATVR is 1.0 when every vertex is transformed once.
+struct MeshOptimizationStatistics {
+	float acmrBefore;
+	float atvrBefore;
+	float acmrAfter;
+	float atvrAfter;
+};
+
+// Simulate a FIFO post-transform vertex cache and return the number of cache misses
+// for the triangle list indices[firstIndex, firstIndex+indexCount) (indexCount -1 means all)
+int computeCacheMisses(std::vector<int> const &indices, int vertexCount, int cacheSize = 16, int firstIndex = 0, int indexCount = -1);
+
+// Reorder the triangles of indices[firstIndex, firstIndex+indexCount) for better 
+// post-transform vertex cache usage. Based on "Fast Triangle Reordering for Vertex 
+// Locality and Reduced Overdraw" (Tipsify) by Sander, Nehab and Barczak 2007.
+void optimizeVertexCache(std::vector<int> &indices, int vertexCount, int cacheSize = 16, int firstIndex = 0, int indexCount = -1);
+
+// Reorder the vertices in the order they are first used by the indices (and update the indices).
+// Normals and uvs are reordered as well if they have one element per position.
+// Vertices not referenced are moved to the end.
+void optimizeVertexFetch(std::vector<int> &indices, 
+	std::vector<vec3> &positions, 
+	std::vector<vec3> &normals, 
+	std::vector<vec2> &uvs);
+
+// Optimize a mesh returned by loadObject: first the vertex cache order within each 
+// submesh (the submesh ranges are preserved) followed by the vertex fetch order.
+//
+// Example usage:
+// loadObject("model.obj", positions, indices, submeshes, materials, normals, uvs);
+// MeshOptimizationStatistics stats = optimizeMesh(indices, positions, normals, uvs, submeshes);
+// cout << "ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter << endl;
+MeshOptimizationStatistics optimizeMesh(std::vector<int> &indices, 
+	std::vector<vec3> &positions, 
+	std::vector<vec3> &normals, 
+	std::vector<vec2> &uvs,
+	std::vector<ObjSubmesh> const &submeshes = std::vector<ObjSubmesh>(),
+	int cacheSize = 16);
+
+#endif
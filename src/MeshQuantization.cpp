@@ -0,0 +1,219 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "MeshQuantization.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+vec3 QuantizedMesh::dequantizePosition(int vertex) const {
+	QuantizedVertex const &v = vertices[vertex];
+	return vec3(positionOffset.x + (v.position[0] / 65535.0f) * positionScale.x,
+		positionOffset.y + (v.position[1] / 65535.0f) * positionScale.y,
+		positionOffset.z + (v.position[2] / 65535.0f) * positionScale.z);
+}
+
+int QuantizedMesh::getByteSize() const {
+	return vertices.size() * sizeof(QuantizedVertex) + 
+		indices16.size() * sizeof(unsigned short) + 
+		indices32.size() * sizeof(unsigned int);
+}
+
+unsigned short floatToHalf(float value){
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(float));
+	unsigned int sign = (bits >> 16) & 0x8000;
+	int exponent = int((bits >> 23) & 0xff) - 127 + 15;
+	unsigned int mantissa = bits & 0x7fffff;
+	if (((bits >> 23) & 0xff) == 0xff){ // inf or nan
+		return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+	}
+	if (exponent >= 31){ // overflow
+		return sign | 0x7c00;
+	}
+	if (exponent <= 0){ // denormal or zero
+		if (exponent < -10){
+			return sign;
+		}
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		unsigned int half = mantissa >> shift;
+		// round to nearest
+		if ((mantissa >> (shift - 1)) & 1){
+			half++;
+		}
+		return sign | half;
+	}
+	unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+	// round to nearest (may carry into the exponent which is correct)
+	if (mantissa & 0x1000){
+		half++;
+	}
+	return half;
+}
+
+float halfToFloat(unsigned short value){
+	unsigned int sign = (value & 0x8000) << 16;
+	unsigned int exponent = (value >> 10) & 0x1f;
+	unsigned int mantissa = value & 0x3ff;
+	unsigned int bits;
+	if (exponent == 0){
+		if (mantissa == 0){
+			bits = sign;
+		} else { // denormal - normalize
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400) == 0){
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+		}
+	} else if (exponent == 31){
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	} else {
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(float));
+	return result;
+}
+
+static float signNotZero(float value){
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+static short toSnorm16(float value){
+	value = max(-1.0f, min(1.0f, value));
+	return (short)floor(value * 32767.0f + 0.5f);
+}
+
+void encodeOctahedral(vec3 normal, short *outEncoded){
+	float sum = fabs(normal.x) + fabs(normal.y) + fabs(normal.z);
+	if (sum == 0){
+		outEncoded[0] = outEncoded[1] = 0;
+		return;
+	}
+	float x = normal.x / sum;
+	float y = normal.y / sum;
+	if (normal.z < 0){
+		float foldedX = (1.0f - fabs(y)) * signNotZero(x);
+		float foldedY = (1.0f - fabs(x)) * signNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+	outEncoded[0] = toSnorm16(x);
+	outEncoded[1] = toSnorm16(y);
+}
+
+vec3 decodeOctahedral(short const *encoded){
+	float x = max(-1.0f, encoded[0] / 32767.0f);
+	float y = max(-1.0f, encoded[1] / 32767.0f);
+	vec3 normal(x, y, 1.0f - fabs(x) - fabs(y));
+	if (normal.z < 0){
+		normal.x = (1.0f - fabs(y)) * signNotZero(x);
+		normal.y = (1.0f - fabs(x)) * signNotZero(y);
+	}
+	return normalize(normal);
+}
+
+void quantizeMesh(vector<int> const &indices, vector<vec3> const &positions, vector<vec3> const &normals, vector<vec2> const &uvs, vector<ObjSubmesh> const &submeshes, QuantizedMesh &outMesh){
+	outMesh.vertices.clear();
+	outMesh.indices16.clear();
+	outMesh.indices32.clear();
+	outMesh.submeshes.clear();
+	int vertexCount = positions.size();
+	bool hasNormals = normals.size() == vertexCount;
+	bool hasUvs = uvs.size() == vertexCount;
+
+	// bounding box
+	vec3 minPosition(0,0,0);
+	vec3 maxPosition(0,0,0);
+	if (vertexCount > 0){
+		minPosition = maxPosition = positions[0];
+	}
+	for (int i=1;i<vertexCount;i++){
+		vec3 p = positions[i];
+		minPosition = vec3(min(minPosition.x, p.x), min(minPosition.y, p.y), min(minPosition.z, p.z));
+		maxPosition = vec3(max(maxPosition.x, p.x), max(maxPosition.y, p.y), max(maxPosition.z, p.z));
+	}
+	outMesh.positionOffset = minPosition;
+	outMesh.positionScale = maxPosition - minPosition;
+
+	outMesh.vertices.resize(vertexCount);
+	for (int i=0;i<vertexCount;i++){
+		QuantizedVertex &v = outMesh.vertices[i];
+		for (int j=0;j<3;j++){
+			float extent = outMesh.positionScale[j];
+			float normalized = extent > 0 ? (positions[i][j] - minPosition[j]) / extent : 0.0f;
+			v.position[j] = (unsigned short)floor(normalized * 65535.0f + 0.5f);
+		}
+		v.position[3] = 0;
+		if (hasNormals){
+			encodeOctahedral(normals[i], v.normal);
+		} else {
+			v.normal[0] = v.normal[1] = 0;
+		}
+		v.uv[0] = hasUvs ? floatToHalf(uvs[i].x) : 0;
+		v.uv[1] = hasUvs ? floatToHalf(uvs[i].y) : 0;
+	}
+
+	vector<ObjSubmesh> ranges = submeshes;
+	if (ranges.empty()){
+		ObjSubmesh all;
+		all.material = -1;
+		all.firstIndex = 0;
+		all.indexCount = indices.size();
+		ranges.push_back(all);
+	}
+	for (int i=0;i<ranges.size();i++){
+		ObjSubmesh const &range = ranges[i];
+		int minIndex = vertexCount;
+		int maxIndex = 0;
+		for (int j=range.firstIndex;j<range.firstIndex+range.indexCount;j++){
+			minIndex = min(minIndex, indices[j]);
+			maxIndex = max(maxIndex, indices[j]);
+		}
+		QuantizedSubmesh submesh;
+		submesh.material = range.material;
+		submesh.indexCount = range.indexCount;
+		submesh.baseVertex = range.indexCount > 0 ? minIndex : 0;
+		submesh.use16BitIndices = maxIndex - submesh.baseVertex <= 0xffff;
+		if (submesh.use16BitIndices){
+			submesh.firstIndex = outMesh.indices16.size();
+			for (int j=range.firstIndex;j<range.firstIndex+range.indexCount;j++){
+				outMesh.indices16.push_back(indices[j] - submesh.baseVertex);
+			}
+		} else {
+			submesh.firstIndex = outMesh.indices32.size();
+			for (int j=range.firstIndex;j<range.firstIndex+range.indexCount;j++){
+				outMesh.indices32.push_back(indices[j] - submesh.baseVertex);
+			}
+		}
+		outMesh.submeshes.push_back(submesh);
+	}
+}
@@ -0,0 +1,91 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __MESH_QUANTIZATION_H
+#define __MESH_QUANTIZATION_H
+
+#include <vector>
+#include "Angel.h"
+#include "ObjLoader.h"
+
+// 16 byte vertex:
+// position: unorm16 relative to the mesh bounding box (GL_UNSIGNED_SHORT, normalized)
+// normal:   octahedral encoded snorm16 (GL_SHORT, normalized)
+// uv:       half floats (GL_HALF_FLOAT)
+struct QuantizedVertex {
+	unsigned short position[4]; // w is unused padding
+	short normal[2];
+	unsigned short uv[2];
+};
+
+// A submesh with its indices stored in either the 16 bit or the 32 bit index list.
+// The indices are relative to baseVertex (use glDrawElementsBaseVertex)
+struct QuantizedSubmesh {
+	int material;
+	int firstIndex;  // offset into indices16 or indices32
+	int indexCount;
+	int baseVertex;
+	bool use16BitIndices;
+};
+
+// Compressed mesh. The position is dequantized using:
+// position = positionOffset + position_unorm * positionScale
+// and the normal is decoded using decodeOctahedral (or the similar GLSL function):
+// vec3 decodeOctahedral(vec2 e){
+//     vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+//     if (n.z < 0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+//     return normalize(n);
+// }
+struct QuantizedMesh {
+	std::vector<QuantizedVertex> vertices;
+	std::vector<unsigned short> indices16;
+	std::vector<unsigned int> indices32;
+	std::vector<QuantizedSubmesh> submeshes;
+	vec3 positionOffset;
+	vec3 positionScale;
+
+	vec3 dequantizePosition(int vertex) const;
+	// the size of the vertex and index data in bytes
+	int getByteSize() const;
+};
+
+// Quantize the output of loadObject. If submeshes is empty the whole mesh is one submesh.
+// Normals and uvs are only used if they have one element per position.
+void quantizeMesh(std::vector<int> const &indices, 
+	std::vector<vec3> const &positions, 
+	std::vector<vec3> const &normals, 
+	std::vector<vec2> const &uvs, 
+	std::vector<ObjSubmesh> const &submeshes, 
+	QuantizedMesh &outMesh);
+
+// IEEE 754 half float conversion
+unsigned short floatToHalf(float value);
+float halfToFloat(unsigned short value);
+
+// Octahedral normal encoding (Meyer et al. "On Floating-Point Normal Vectors" 2010)
+void encodeOctahedral(vec3 normal, short *outEncoded);
+vec3 decodeOctahedral(short const *encoded);
+
+#endif
@@ -0,0 +1,193 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "Meshlet.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+void MeshletTable::clear(){
+	indexOffset.clear();
+	triangleCount.clear();
+	vertexCount.clear();
+	boundingSphere.clear();
+	coneApex.clear();
+	coneAxisCutoff.clear();
+}
+
+bool MeshletTable::isBackfacing(int meshlet, vec3 cameraPosition) const {
+	vec4 axisCutoff = coneAxisCutoff[meshlet];
+	vec3 axis(axisCutoff.x, axisCutoff.y, axisCutoff.z);
+	vec3 direction = coneApex[meshlet] - cameraPosition;
+	float directionLength = length(direction);
+	if (directionLength == 0){
+		return false;
+	}
+	return dot(direction, axis) >= axisCutoff.w * directionLength;
+}
+
+bool MeshletTable::isOutsideFrustum(int meshlet, vec4 const * frustumPlanes) const {
+	vec4 sphere = boundingSphere[meshlet];
+	vec4 center(sphere.x, sphere.y, sphere.z, 1.0f);
+	for (int i=0;i<6;i++){
+		if (dot(frustumPlanes[i], center) < -sphere.w){
+			return true;
+		}
+	}
+	return false;
+}
+
+// compute bounds and normal cone of the triangles in indices[first, first+triangleCount*3)
+static void addMeshletBounds(MeshletTable &outMeshlets, vector<int> const &indices, vector<vec3> const &positions, int first, int triangleCount){
+	// bounding sphere centered in the bounding box 
+	vec3 minPosition = positions[indices[first]];
+	vec3 maxPosition = minPosition;
+	for (int i=first;i<first+triangleCount*3;i++){
+		vec3 p = positions[indices[i]];
+		minPosition = vec3(min(minPosition.x, p.x), min(minPosition.y, p.y), min(minPosition.z, p.z));
+		maxPosition = vec3(max(maxPosition.x, p.x), max(maxPosition.y, p.y), max(maxPosition.z, p.z));
+	}
+	vec3 center = (minPosition + maxPosition) * 0.5f;
+	float radius = 0;
+	for (int i=first;i<first+triangleCount*3;i++){
+		radius = max(radius, length(positions[indices[i]] - center));
+	}
+	outMeshlets.boundingSphere.push_back(vec4(center, radius));
+
+	// normal cone based on "Optimizing the Graphics Pipeline with Compute" by Wihlidal 2016
+	vector<vec3> normals;
+	vec3 axis(0,0,0);
+	for (int i=0;i<triangleCount;i++){
+		vec3 p0 = positions[indices[first+i*3]];
+		vec3 p1 = positions[indices[first+i*3+1]];
+		vec3 p2 = positions[indices[first+i*3+2]];
+		vec3 normal = cross(p1 - p0, p2 - p0);
+		float area = length(normal);
+		if (area == 0){
+			continue; // degenerate triangle
+		}
+		normal = normal / area;
+		normals.push_back(normal);
+		axis += normal;
+	}
+	float axisLength = length(axis);
+	float minDot = 1;
+	if (axisLength > 0){
+		axis = axis / axisLength;
+		for (int i=0;i<normals.size();i++){
+			minDot = min(minDot, dot(axis, normals[i]));
+		}
+	}
+	if (axisLength == 0 || minDot <= 0.1f){
+		// cone spans more than a hemisphere - never backfacing
+		outMeshlets.coneApex.push_back(center);
+		outMeshlets.coneAxisCutoff.push_back(vec4(0,0,0,1));
+		return;
+	}
+	// move the apex backwards until all triangle planes are in front of it
+	float maxT = 0;
+	for (int i=0, n=0;i<triangleCount;i++){
+		vec3 p0 = positions[indices[first+i*3]];
+		vec3 p1 = positions[indices[first+i*3+1]];
+		vec3 p2 = positions[indices[first+i*3+2]];
+		if (length(cross(p1 - p0, p2 - p0)) == 0){
+			continue;
+		}
+		vec3 normal = normals[n++];
+		float t = dot(center - p0, normal) / dot(axis, normal);
+		maxT = max(maxT, t);
+	}
+	outMeshlets.coneApex.push_back(center - axis * maxT);
+	outMeshlets.coneAxisCutoff.push_back(vec4(axis, sqrt(1.0f - minDot * minDot)));
+}
+
+static void addMeshlet(MeshletTable &outMeshlets, vector<int> const &indices, vector<vec3> const &positions, int first, int triangleCount, int vertexCount){
+	outMeshlets.indexOffset.push_back(first);
+	outMeshlets.triangleCount.push_back(triangleCount);
+	outMeshlets.vertexCount.push_back(vertexCount);
+	addMeshletBounds(outMeshlets, indices, positions, first, triangleCount);
+}
+
+void buildMeshlets(MeshletTable &outMeshlets, vector<int> const &indices, vector<vec3> const &positions, int maxVertices, int maxTriangles, int firstIndex, int indexCount){
+	if (indexCount < 0){
+		indexCount = indices.size() - firstIndex;
+	}
+	// marks the meshlet a vertex was last added to
+	vector<int> vertexMeshlet(positions.size(), -1);
+	int meshlet = outMeshlets.size();
+	int meshletFirst = firstIndex;
+	int triangleCount = 0;
+	int vertexCount = 0;
+	for (int i=firstIndex;i+2<firstIndex+indexCount;i+=3){
+		int newVertices = 0;
+		for (int j=0;j<3;j++){
+			if (vertexMeshlet[indices[i+j]] != meshlet && 
+				(j < 1 || indices[i+j] != indices[i]) && 
+				(j < 2 || indices[i+j] != indices[i+1])){
+				newVertices++;
+			}
+		}
+		if (triangleCount > 0 && 
+			(triangleCount + 1 > maxTriangles || vertexCount + newVertices > maxVertices)){
+			addMeshlet(outMeshlets, indices, positions, meshletFirst, triangleCount, vertexCount);
+			meshlet++;
+			meshletFirst = i;
+			triangleCount = 0;
+			vertexCount = 0;
+			i -= 3; // recount the vertices for the new meshlet
+			continue;
+		}
+		for (int j=0;j<3;j++){
+			vertexMeshlet[indices[i+j]] = meshlet;
+		}
+		vertexCount += newVertices;
+		triangleCount++;
+	}
+	if (triangleCount > 0){
+		addMeshlet(outMeshlets, indices, positions, meshletFirst, triangleCount, vertexCount);
+	}
+}
+
+void extractFrustumPlanes(mat4 const &projectionModelView, vec4 *outPlanes){
+	// Gribb and Hartmann - rows of the (row-major) matrix
+	vec4 row0 = projectionModelView[0];
+	vec4 row1 = projectionModelView[1];
+	vec4 row2 = projectionModelView[2];
+	vec4 row3 = projectionModelView[3];
+	outPlanes[0] = row3 + row0;
+	outPlanes[1] = row3 - row0;
+	outPlanes[2] = row3 + row1;
+	outPlanes[3] = row3 - row1;
+	outPlanes[4] = row3 + row2;
+	outPlanes[5] = row3 - row2;
+	for (int i=0;i<6;i++){
+		float planeLength = length(vec3(outPlanes[i].x, outPlanes[i].y, outPlanes[i].z));
+		if (planeLength > 0){
+			outPlanes[i] = outPlanes[i] / planeLength;
+		}
+	}
+}
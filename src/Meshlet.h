@@ -0,0 +1,86 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __MESHLET_H
+#define __MESHLET_H
+
+#include <vector>
+#include "Angel.h"
+
+// Meshlets (clusters) of a triangle mesh stored as a structure of arrays.
+// Each meshlet is a contiguous range of the index list with a bounded number of 
+// unique vertices and triangles, so it can be drawn directly with glDrawElements using
+// indexOffset and triangleCount*3. Each meshlet has a bounding sphere and a normal cone 
+// used for culling meshlets outside the view frustum or facing away from the camera.
+//
+// Example usage:
+// MeshletTable meshlets;
+// for (int i=0;i<submeshes.size();i++){
+//     buildMeshlets(meshlets, indices, positions, 64, 124, submeshes[i].firstIndex, submeshes[i].indexCount);
+// }
+// vec4 frustumPlanes[6];
+// extractFrustumPlanes(projection * modelView, frustumPlanes);
+// for (int i=0;i<meshlets.size();i++){
+//     if (meshlets.isVisible(i, cameraPosition, frustumPlanes)){
+//         glDrawElements(GL_TRIANGLES, meshlets.triangleCount[i]*3, GL_UNSIGNED_INT, (GLvoid*)(meshlets.indexOffset[i]*sizeof(GLuint)));
+//     }
+// }
+struct MeshletTable {
+	std::vector<int> indexOffset;              // first index in the index list
+	std::vector<unsigned short> triangleCount;
+	std::vector<unsigned short> vertexCount;   // number of unique vertices
+	std::vector<vec4> boundingSphere;          // xyz is center, w is radius
+	std::vector<vec3> coneApex;
+	std::vector<vec4> coneAxisCutoff;          // xyz is the (normalized) axis, w is the cutoff
+
+	int size() const { return indexOffset.size(); }
+	void clear();
+
+	// true if all triangles of the meshlet are facing away from the camera
+	bool isBackfacing(int meshlet, vec3 cameraPosition) const;
+	// true if the bounding sphere is outside one of the frustum planes (see extractFrustumPlanes)
+	bool isOutsideFrustum(int meshlet, vec4 const * frustumPlanes) const;
+	bool isVisible(int meshlet, vec3 cameraPosition, vec4 const * frustumPlanes) const {
+		return !isOutsideFrustum(meshlet, frustumPlanes) && !isBackfacing(meshlet, cameraPosition);
+	}
+};
+
+// Partition the triangle list indices[firstIndex, firstIndex+indexCount) into meshlets 
+// with at most maxVertices unique vertices and maxTriangles triangles and append them to 
+// the table (indexCount -1 means all). The triangle order is not changed, so the result 
+// benefits from running optimizeVertexCache first.
+void buildMeshlets(MeshletTable &outMeshlets, 
+	std::vector<int> const &indices, 
+	std::vector<vec3> const &positions, 
+	int maxVertices = 64, 
+	int maxTriangles = 124, 
+	int firstIndex = 0, 
+	int indexCount = -1);
+
+// Extract the six normalized frustum planes (left, right, bottom, top, near, far) from a 
+// projection * modelView matrix. A point p is inside a plane if dot(plane, vec4(p,1)) >= 0
+void extractFrustumPlanes(mat4 const &projectionModelView, vec4 *outPlanes);
+
+#endif
@@ -0,0 +1,350 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "MipmapGenerator.h"
+#include "TextureLoader.h"
+#include "Profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+using namespace std;
+
+static const float PI = 3.14159265f;
+
+// sRGB conversion tables
+static float srgbToLinearTable[256];
+static unsigned char linearToSrgbTable[4096];
+static bool tablesInitialized = false;
+
+static void initTables(){
+	if (tablesInitialized){
+		return;
+	}
+	for (int i=0;i<256;i++){
+		float c = i / 255.0f;
+		srgbToLinearTable[i] = c <= 0.04045f ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+	for (int i=0;i<4096;i++){
+		float c = i / 4095.0f;
+		float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * pow(c, 1.0f / 2.4f) - 0.055f;
+		linearToSrgbTable[i] = (unsigned char)(srgb * 255.0f + 0.5f);
+	}
+	tablesInitialized = true;
+}
+
+static unsigned char toByte(float value, bool srgb){
+	value = max(0.0f, min(1.0f, value));
+	if (srgb){
+		return linearToSrgbTable[(int)(value * 4095.0f + 0.5f)];
+	}
+	return (unsigned char)(value * 255.0f + 0.5f);
+}
+
+static float sinc(float x){
+	if (fabs(x) < 1e-6f){
+		return 1.0f;
+	}
+	x *= PI;
+	return sin(x) / x;
+}
+
+// zeroth order modified Bessel function of the first kind
+static float bessel0(float x){
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int k=1;k<20;k++){
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static const float KAISER_ALPHA = 4.0f;
+static const float KAISER_SUPPORT = 3.0f;
+static const float LANCZOS_SUPPORT = 3.0f;
+
+static float filterSupport(MipmapFilter filter){
+	return filter == MIPMAP_KAISER ? KAISER_SUPPORT : LANCZOS_SUPPORT;
+}
+
+static float filterWeight(MipmapFilter filter, float x){
+	if (filter == MIPMAP_KAISER){
+		float t = x / KAISER_SUPPORT;
+		if (fabs(t) >= 1.0f){
+			return 0;
+		}
+		return sinc(x) * bessel0(KAISER_ALPHA * sqrt(1.0f - t * t)) / bessel0(KAISER_ALPHA);
+	}
+	if (fabs(x) >= LANCZOS_SUPPORT){
+		return 0;
+	}
+	return sinc(x) * sinc(x / LANCZOS_SUPPORT);
+}
+
+// weights of the source samples contributing to each destination sample
+struct FilterTaps {
+	std::vector<int> first;      // first source sample of each destination sample
+	int count;                   // taps per destination sample
+	std::vector<float> weights;  // count weights per destination sample
+};
+
+static void computeTaps(MipmapFilter filter, int srcSize, int dstSize, FilterTaps &taps){
+	float scale = srcSize / float(dstSize);
+	float support = filterSupport(filter) * scale;
+	taps.count = (int)ceil(support * 2) + 1;
+	taps.first.resize(dstSize);
+	taps.weights.resize(dstSize * taps.count);
+	for (int i=0;i<dstSize;i++){
+		float center = (i + 0.5f) * scale;
+		int first = (int)floor(center - support);
+		taps.first[i] = first;
+		float sum = 0;
+		for (int j=0;j<taps.count;j++){
+			float weight = filterWeight(filter, (first + j + 0.5f - center) / scale);
+			taps.weights[i*taps.count + j] = weight;
+			sum += weight;
+		}
+		for (int j=0;j<taps.count;j++){
+			taps.weights[i*taps.count + j] /= sum;
+		}
+	}
+}
+
+// downsample a linear RGBA float image by a factor of two
+static void downsample(const std::vector<float> &src, int srcWidth, int srcHeight, 
+	std::vector<float> &dst, int dstWidth, int dstHeight, MipmapFilter filter){
+	dst.resize(dstWidth * dstHeight * 4);
+	if (filter == MIPMAP_BOX){
+#ifdef _OPENMP
+		#pragma omp parallel for
+#endif
+		for (int y=0;y<dstHeight;y++){
+			int y0 = min(y*2, srcHeight-1);
+			int y1 = min(y*2+1, srcHeight-1);
+			const float * row0 = &src[y0 * srcWidth * 4];
+			const float * row1 = &src[y1 * srcWidth * 4];
+			float * out = &dst[y * dstWidth * 4];
+			for (int x=0;x<dstWidth;x++){
+				int x0 = min(x*2, srcWidth-1) * 4;
+				int x1 = min(x*2+1, srcWidth-1) * 4;
+				for (int c=0;c<4;c++){
+					out[x*4+c] = (row0[x0+c] + row0[x1+c] + row1[x0+c] + row1[x1+c]) * 0.25f;
+				}
+			}
+		}
+		return;
+	}
+	// separable filter: horizontal pass followed by vertical pass
+	FilterTaps tapsX;
+	FilterTaps tapsY;
+	computeTaps(filter, srcWidth, dstWidth, tapsX);
+	computeTaps(filter, srcHeight, dstHeight, tapsY);
+	std::vector<float> horizontal(dstWidth * srcHeight * 4);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y=0;y<srcHeight;y++){
+		const float * row = &src[y * srcWidth * 4];
+		float * out = &horizontal[y * dstWidth * 4];
+		for (int x=0;x<dstWidth;x++){
+			float sum[4] = {0,0,0,0};
+			const float * weights = &tapsX.weights[x * tapsX.count];
+			for (int j=0;j<tapsX.count;j++){
+				int sx = max(0, min(srcWidth-1, tapsX.first[x] + j)) * 4;
+				for (int c=0;c<4;c++){
+					sum[c] += row[sx+c] * weights[j];
+				}
+			}
+			for (int c=0;c<4;c++){
+				out[x*4+c] = sum[c];
+			}
+		}
+	}
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int y=0;y<dstHeight;y++){
+		float * out = &dst[y * dstWidth * 4];
+		for (int i=0;i<dstWidth*4;i++){
+			out[i] = 0;
+		}
+		const float * weights = &tapsY.weights[y * tapsY.count];
+		for (int j=0;j<tapsY.count;j++){
+			int sy = max(0, min(srcHeight-1, tapsY.first[y] + j));
+			const float * row = &horizontal[sy * dstWidth * 4];
+			float weight = weights[j];
+			for (int i=0;i<dstWidth*4;i++){
+				out[i] += row[i] * weight;
+			}
+		}
+	}
+}
+
+void generateMipmaps(const unsigned char * rgba, int width, int height, MipmapChain &outChain, MipmapFilter filter, bool srgb){
+	initTables();
+	outChain.srgb = srgb;
+	outChain.filter = filter;
+	outChain.levels.clear();
+	int totalSize = 0;
+	for (int w=width, h=height;;w=max(1,w/2), h=max(1,h/2)){
+		MipmapLevel level;
+		level.width = w;
+		level.height = h;
+		level.offset = totalSize;
+		outChain.levels.push_back(level);
+		totalSize += w * h * 4;
+		if (w == 1 && h == 1){
+			break;
+		}
+	}
+	outChain.data.resize(totalSize);
+	memcpy(&outChain.data[0], rgba, width * height * 4);
+
+	// filter in linear space
+	std::vector<float> current(width * height * 4);
+#ifdef _OPENMP
+	#pragma omp parallel for
+#endif
+	for (int i=0;i<width * height;i++){
+		for (int c=0;c<3;c++){
+			current[i*4+c] = srgb ? srgbToLinearTable[rgba[i*4+c]] : rgba[i*4+c] / 255.0f;
+		}
+		current[i*4+3] = rgba[i*4+3] / 255.0f;
+	}
+	std::vector<float> next;
+	for (int l=1;l<outChain.levels.size();l++){
+		MipmapLevel &previous = outChain.levels[l-1];
+		MipmapLevel &level = outChain.levels[l];
+		downsample(current, previous.width, previous.height, next, level.width, level.height, filter);
+		unsigned char * out = &outChain.data[level.offset];
+		int pixelCount = level.width * level.height;
+#ifdef _OPENMP
+		#pragma omp parallel for
+#endif
+		for (int i=0;i<pixelCount;i++){
+			for (int c=0;c<3;c++){
+				out[i*4+c] = toByte(next[i*4+c], srgb);
+			}
+			out[i*4+3] = toByte(next[i*4+3], false);
+		}
+		current.swap(next);
+	}
+}
+
+void uploadMipmaps(const MipmapChain &chain, GLenum target){
+	PROFILE_GPU_SCOPE("uploadMipmaps");
+	PROFILE_BYTES_UPLOADED(chain.data.size());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	for (int i=0;i<chain.levels.size();i++){
+		const MipmapLevel &level = chain.levels[i];
+		glTexImage2D(target, i, chain.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8, level.width, level.height, 0, 
+			GL_RGBA, GL_UNSIGNED_BYTE, chain.getPixels(i));
+	}
+	glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, chain.levels.size()-1);
+}
+
+// cache file layout (little endian 32 bit integers):
+// "MIPC", version, srgb, filter, levelCount, (width, height) per level, pixels of all levels
+static const char MIPMAP_CACHE_MAGIC[4] = {'M','I','P','C'};
+static const int MIPMAP_CACHE_VERSION = 2;
+
+bool saveMipmapCache(const char * cachepath, const MipmapChain &chain){
+	FILE * file = fopen(cachepath, "wb");
+	if (!file){
+		printf("Mipmap cache could not be written %s\n", cachepath);
+		return false;
+	}
+	int header[4] = {MIPMAP_CACHE_VERSION, chain.srgb ? 1 : 0, (int)chain.filter, (int)chain.levels.size()};
+	fwrite(MIPMAP_CACHE_MAGIC, 1, 4, file);
+	fwrite(header, sizeof(int), 4, file);
+	for (int i=0;i<chain.levels.size();i++){
+		int size[2] = {chain.levels[i].width, chain.levels[i].height};
+		fwrite(size, sizeof(int), 2, file);
+	}
+	bool ok = fwrite(&chain.data[0], 1, chain.data.size(), file) == chain.data.size();
+	fclose(file);
+	return ok;
+}
+
+bool loadMipmapCache(const char * cachepath, MipmapChain &outChain){
+	FILE * file = fopen(cachepath, "rb");
+	if (!file){
+		return false;
+	}
+	char magic[4];
+	int header[4];
+	if (fread(magic, 1, 4, file) != 4 || memcmp(magic, MIPMAP_CACHE_MAGIC, 4) != 0 ||
+		fread(header, sizeof(int), 4, file) != 4 || header[0] != MIPMAP_CACHE_VERSION || 
+		header[3] <= 0 || header[3] > 32){
+		fclose(file);
+		return false;
+	}
+	outChain.srgb = header[1] != 0;
+	outChain.filter = (MipmapFilter)header[2];
+	outChain.levels.resize(header[3]);
+	int totalSize = 0;
+	for (int i=0;i<header[3];i++){
+		int size[2];
+		if (fread(size, sizeof(int), 2, file) != 2 || size[0] <= 0 || size[1] <= 0){
+			fclose(file);
+			return false;
+		}
+		outChain.levels[i].width = size[0];
+		outChain.levels[i].height = size[1];
+		outChain.levels[i].offset = totalSize;
+		totalSize += size[0] * size[1] * 4;
+	}
+	outChain.data.resize(totalSize);
+	bool ok = fread(&outChain.data[0], 1, totalSize, file) == totalSize;
+	fclose(file);
+	return ok;
+}
+
+bool loadMipmaps(const char * imagepath, const char * cachepath, MipmapChain &outChain, MipmapFilter filter, bool srgb){
+	struct stat imageStat;
+	struct stat cacheStat;
+	bool imageExists = stat(imagepath, &imageStat) == 0;
+	bool cacheValid = stat(cachepath, &cacheStat) == 0 && 
+		(!imageExists || cacheStat.st_mtime >= imageStat.st_mtime);
+	if (cacheValid && loadMipmapCache(cachepath, outChain) && 
+		outChain.srgb == srgb && outChain.filter == filter){
+		return true;
+	}
+	unsigned int width, height;
+	unsigned char * rgba = loadBMPRGBA(imagepath, width, height);
+	if (rgba == NULL){
+		return false;
+	}
+	generateMipmaps(rgba, width, height, outChain, filter, srgb);
+	delete [] rgba;
+	saveMipmapCache(cachepath, outChain);
+	return true;
+}
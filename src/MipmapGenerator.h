@@ -0,0 +1,81 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __MIPMAP_GENERATOR_H
+#define __MIPMAP_GENERATOR_H
+
+#include <vector>
+#include "Angel.h"
+
+enum MipmapFilter {
+	MIPMAP_BOX,     // 2x2 average
+	MIPMAP_KAISER,  // Kaiser windowed sinc (sharper than box, little ringing)
+	MIPMAP_LANCZOS  // Lanczos 3 (sharpest)
+};
+
+struct MipmapLevel {
+	int width;
+	int height;
+	int offset; // offset of the RGBA pixels in MipmapChain::data
+};
+
+// All mipmap levels of an RGBA8 image stored in one block of memory
+struct MipmapChain {
+	std::vector<MipmapLevel> levels;
+	std::vector<unsigned char> data;
+	bool srgb;
+	MipmapFilter filter; // the filter used to generate the levels
+
+	const unsigned char * getPixels(int level) const { return &data[levels[level].offset]; }
+};
+
+// Generate the full mipmap chain (down to 1x1) of an RGBA8 image on the CPU.
+// If srgb is true the color channels are filtered in linear space (alpha is always linear).
+// The rows of each level are filtered in parallel using OpenMP (when enabled).
+void generateMipmaps(const unsigned char * rgba, int width, int height, MipmapChain &outChain, 
+	MipmapFilter filter = MIPMAP_BOX, bool srgb = true);
+
+// Upload all levels to the currently bound texture (as GL_SRGB8_ALPHA8 if the chain is srgb)
+void uploadMipmaps(const MipmapChain &chain, GLenum target = GL_TEXTURE_2D);
+
+// Binary mipmap cache file storing all levels for direct upload
+bool saveMipmapCache(const char * cachepath, const MipmapChain &chain);
+bool loadMipmapCache(const char * cachepath, MipmapChain &outChain);
+
+// Loads the mipmap chain from the cache file if it is newer than the image (and was generated
+// with the same filter and srgb setting), otherwise loads the image (see loadBMPRGBA), 
+// generates the mipmaps and writes the cache file.
+//
+// Example usage:
+// MipmapChain chain;
+// if (loadMipmaps("brick.bmp", "brick.mip", chain)){
+//     glBindTexture(GL_TEXTURE_2D, textureId);
+//     uploadMipmaps(chain);
+//     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+// }
+bool loadMipmaps(const char * imagepath, const char * cachepath, MipmapChain &outChain, 
+	MipmapFilter filter = MIPMAP_BOX, bool srgb = true);
+
+#endif
@@ -0,0 +1,176 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "NURBSGPUEvaluator.h"
+
+#include <iostream>
+
+#include "ShaderRegistry.h"
+#include "Profiler.h"
+
+using namespace std;
+
+GLuint NURBSGPUEvaluator::shaderProgram = 0;
+GLint NURBSGPUEvaluator::controlPointsUniform = -1;
+GLint NURBSGPUEvaluator::knotsUniform = -1;
+GLint NURBSGPUEvaluator::numberOfControlPointsUniform = -1;
+GLint NURBSGPUEvaluator::degreeUniform = -1;
+GLint NURBSGPUEvaluator::discretizationUniform = -1;
+GLint NURBSGPUEvaluator::minParameterUniform = -1;
+GLint NURBSGPUEvaluator::deltaParameterUniform = -1;
+
+NURBSGPUEvaluator::NURBSGPUEvaluator(NURBSSurface * surface)
+	: surface(surface) {
+	if (shaderProgram == 0){
+		setupShader();
+	}
+	glGenVertexArrays(1, &vao);
+
+	glGenBuffers(1, &controlPointBuffer);
+	glGenTextures(1, &controlPointTexture);
+	glGenBuffers(1, &knotBuffer);
+	glGenTextures(1, &knotTexture);
+}
+
+NURBSGPUEvaluator::~NURBSGPUEvaluator(){
+	glDeleteTextures(1, &controlPointTexture);
+	glDeleteBuffers(1, &controlPointBuffer);
+	glDeleteTextures(1, &knotTexture);
+	glDeleteBuffers(1, &knotBuffer);
+	glDeleteVertexArrays(1, &vao);
+}
+
+void NURBSGPUEvaluator::setupShader(){
+	// the outputs are captured in the same layout as NURBSVertex
+	vector<string> varyings;
+	varyings.push_back("position");
+	varyings.push_back("normal");
+	varyings.push_back("uv");
+	shaderProgram = ShaderRegistry::getTransformFeedbackProgram("nurbseval.vert", varyings);
+	if (shaderProgram == 0){
+		return;
+	}
+	controlPointsUniform = glGetUniformLocation(shaderProgram, "controlPoints");
+	knotsUniform = glGetUniformLocation(shaderProgram, "knots");
+	numberOfControlPointsUniform = glGetUniformLocation(shaderProgram, "numberOfControlPoints");
+	degreeUniform = glGetUniformLocation(shaderProgram, "degree");
+	discretizationUniform = glGetUniformLocation(shaderProgram, "discretization");
+	minParameterUniform = glGetUniformLocation(shaderProgram, "minParameter");
+	deltaParameterUniform = glGetUniformLocation(shaderProgram, "deltaParameter");
+}
+
+int NURBSGPUEvaluator::getVertexCount(){
+	if (surface->getDegreeU() < 0 || surface->getDegreeV() < 0){
+		return 0;
+	}
+	return surface->getDiscretizationU() * surface->getDiscretizationV();
+}
+
+bool NURBSGPUEvaluator::isSupported(){
+	return shaderProgram != 0 &&
+		surface->getDegreeU() >= 0 && surface->getDegreeV() >= 0 &&
+		surface->getKnotVectorSizeU() <= MAX_KNOT_VECTOR_SIZE &&
+		surface->getKnotVectorSizeV() <= MAX_KNOT_VECTOR_SIZE;
+}
+
+void NURBSGPUEvaluator::uploadData(){
+	vector<vec4> controlPoints = surface->getControlPoints();
+	glBindBuffer(GL_TEXTURE_BUFFER, controlPointBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, controlPoints.size() * sizeof(vec4), &controlPoints[0], GL_DYNAMIC_DRAW);
+
+	vector<float> knots(surface->getKnotVectorU());
+	knots.insert(knots.end(), surface->getKnotVectorV().begin(), surface->getKnotVectorV().end());
+	glBindBuffer(GL_TEXTURE_BUFFER, knotBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, knots.size() * sizeof(float), &knots[0], GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	PROFILE_BYTES_UPLOADED(controlPoints.size() * sizeof(vec4) + knots.size() * sizeof(float));
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_BUFFER, knotTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, knotBuffer);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, controlPointTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, controlPointBuffer);
+}
+
+bool NURBSGPUEvaluator::evaluate(GLuint buffer, GLintptr offset){
+	if (!isSupported()){
+		cerr << "NURBSGPUEvaluator: Surface cannot be evaluated on the GPU" << endl;
+		return false;
+	}
+	uploadData();
+
+	int degreeU = surface->getDegreeU();
+	int degreeV = surface->getDegreeV();
+	vector<float> const &knotVectorU = surface->getKnotVectorU();
+	vector<float> const &knotVectorV = surface->getKnotVectorV();
+	// same parameter range as NURBSSurface::getMeshData()
+	float minU = knotVectorU[degreeU];
+	float maxU = knotVectorU[knotVectorU.size()-1-degreeU];
+	float minV = knotVectorV[degreeV];
+	float maxV = knotVectorV[knotVectorV.size()-1-degreeV];
+
+	glUseProgram(shaderProgram);
+	glUniform1i(controlPointsUniform, 0);
+	glUniform1i(knotsUniform, 1);
+	glUniform2i(numberOfControlPointsUniform, surface->getNumberOfControlPointsU(), surface->getNumberOfControlPointsV());
+	glUniform2i(degreeUniform, degreeU, degreeV);
+	glUniform2i(discretizationUniform, surface->getDiscretizationU(), surface->getDiscretizationV());
+	glUniform2f(minParameterUniform, minU, minV);
+	glUniform2f(deltaParameterUniform, (maxU - minU) * 0.99999f, (maxV - minV) * 0.99999f);
+
+	int vertexCount = getVertexCount();
+	glBindVertexArray(vao);
+	glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer, offset, vertexCount * sizeof(NURBSVertex));
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, vertexCount);
+	glEndTransformFeedback();
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindVertexArray(0);
+	return true;
+}
+
+std::vector<NURBSVertex> NURBSGPUEvaluator::getMeshData(){
+	vector<NURBSVertex> res;
+	int vertexCount = getVertexCount();
+	if (vertexCount == 0){
+		return res;
+	}
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(NURBSVertex), NULL, GL_STREAM_READ);
+	if (evaluate(buffer)){
+		res.resize(vertexCount);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * sizeof(NURBSVertex), &res[0]);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+	return res;
+}
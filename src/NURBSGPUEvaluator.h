@@ -0,0 +1,95 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _NURBS_GPU_EVALUATOR_H
+#define _NURBS_GPU_EVALUATOR_H
+
+#include <vector>
+#include "Angel.h"
+#include "NURBSSurface.h"
+
+/// Evaluates a NURBS surface on the GPU. Only the control points and knot vectors are uploaded
+/// (as buffer textures) and the vertices are evaluated in a vertex shader over the same parameter 
+/// grid as NURBSSurface::getMeshData(). The result is captured using transform feedback into a 
+/// buffer using the NURBSVertex layout (so it can be rendered using the indices from 
+/// NURBSSurface::getMeshDataIndices()). 
+/// NURBSSurface::getMeshData() is the reference implementation - the results are equal within 
+/// floating point precision.
+/// Example usage:
+///
+/// NURBSGPUEvaluator *evaluator = new NURBSGPUEvaluator(surface);
+/// // ---- each time the control points have changed
+/// evaluator->evaluate(vertexBuffer); // vertexBuffer size must be at least getVertexCount() * sizeof(NURBSVertex)
+///
+/// Note that NURBSRenderer::setGPUEvaluation(true) does this automatically.
+class NURBSGPUEvaluator
+{
+public:
+	NURBSGPUEvaluator(NURBSSurface * surface);
+	~NURBSGPUEvaluator();
+
+	/// Uploads the control points and knot vectors and writes the evaluated vertices to the buffer 
+	/// at the offset (in bytes). Returns false if the surface cannot be evaluated on the GPU.
+	bool evaluate(GLuint buffer, GLintptr offset = 0);
+
+	/// Evaluates the surface on the GPU and reads back the result (mainly useful for comparing with
+	/// NURBSSurface::getMeshData())
+	std::vector<NURBSVertex> getMeshData();
+
+	/// number of vertices written by evaluate (discretizationU * discretizationV)
+	int getVertexCount();
+
+	/// Returns true if the surface can be evaluated on the GPU (the knot vectors must be
+	/// valid and not larger than MAX_KNOT_VECTOR_SIZE)
+	bool isSupported();
+
+	/// compiles the shader (done automatically by the constructor)
+	static void setupShader();
+
+	/// maximum size of each knot vector (must match MAX_KNOTS in nurbseval.vert)
+	static const int MAX_KNOT_VECTOR_SIZE = 64;
+private:
+	void uploadData();
+
+	NURBSSurface * surface;
+
+	GLuint vao; // empty vertex array object (the vertex shader has no attributes)
+	GLuint controlPointBuffer;
+	GLuint controlPointTexture;
+	GLuint knotBuffer;
+	GLuint knotTexture;
+
+	static GLuint shaderProgram;
+	static GLint controlPointsUniform,
+		knotsUniform,
+		numberOfControlPointsUniform,
+		degreeUniform,
+		discretizationUniform,
+		minParameterUniform,
+		deltaParameterUniform;
+};
+
+#endif // _NURBS_GPU_EVALUATOR_H
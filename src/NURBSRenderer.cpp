@@ -25,20 +25,64 @@
  */
 #include "NURBSRenderer.h"
 
+#include <cstring>
+
+#include "ShaderRegistry.h"
+#include "NURBSSurface.h"
+#include "NURBSGPUEvaluator.h"
+#include "Profiler.h"
+
 using namespace std;
 
 GLuint NURBSRenderer::shaderProgram = 0;
-GLuint NURBSRenderer::projectionUniform = 0;
-GLuint NURBSRenderer::modelViewUniform = 0;
-GLuint NURBSRenderer::lightPositionUniform = 0;
-GLuint NURBSRenderer::colorUniform = 0;
+
+GLuint NURBSRenderer::perFrameBuffer = 0;
+GLuint NURBSRenderer::perObjectBuffer = 0;
+GLint NURBSRenderer::perObjectStride = 0;
+GLint NURBSRenderer::perObjectOffset = 0;
+
+bool NURBSRenderer::programBound = false;
+GLuint NURBSRenderer::boundVao = 0;
+float NURBSRenderer::boundPointSize = -1;
+
+namespace {
+	// uniform buffer binding points
+	const GLuint PER_FRAME_BINDING = 0;
+	const GLuint PER_OBJECT_BINDING = 1;
+	// number of objects that fits into the per object buffer before it is orphaned
+	const int PER_OBJECT_CAPACITY = 1024;
+
+	// layout of the uniform blocks in nurbs.vert (std140)
+	struct PerFrameData {
+		mat4 projection;
+		vec4 lightPosition;
+	};
+
+	struct PerObjectData {
+		mat4 modelView;
+		vec4 color;
+	};
+
+	PerFrameData currentFrameData;
+	bool frameDataValid = false;
+
+	// a line from each vertex in the direction of the normal
+	vector<vec4> createNormalLines(const vector<NURBSVertex> &meshData){
+		vector<vec4> normals;
+		for (int i=0;i<meshData.size();i++){
+			normals.push_back(meshData[i].position);
+			normals.push_back(meshData[i].position + vec4(meshData[i].normal,0));
+		}
+		return normals;
+	}
+}
 
 GLuint NURBSRenderer::positionAttribute = 0; 
 GLuint NURBSRenderer::normalAttribute = 0; 
 GLuint NURBSRenderer::uvAttribute = 0;
 
 NURBSRenderer::NURBSRenderer(NURBS * nurbs) 
-	: nurbs(nurbs), vao(0), color(1,0,0,1) {
+	: nurbs(nurbs), gpuEvaluator(NULL), vao(0), gpuNormalsValid(false), color(1,0,0,1) {
 
 	if (shaderProgram == 0){
 		setupShader();
@@ -47,26 +91,49 @@ NURBSRenderer::NURBSRenderer(NURBS * nurbs)
 }
 
 NURBSRenderer::~NURBSRenderer() {
+	delete gpuEvaluator;
 }
 
-void NURBSRenderer::setupShader(){
-	shaderProgram = InitShader("nurbs.vert",  "nurbs.frag", "fragColour");
-	projectionUniform = glGetUniformLocation(shaderProgram, "projection");
-	if (projectionUniform == GL_INVALID_INDEX) {
-		cerr << "Shader did not contain the 'projection' uniform."<<endl;
+bool NURBSRenderer::setGPUEvaluation(bool enabled){
+	if (enabled == (gpuEvaluator != NULL)){
+		return true;
 	}
-	modelViewUniform = glGetUniformLocation(shaderProgram, "modelView");
-	if (modelViewUniform == GL_INVALID_INDEX) {
-		cerr << "Shader did not contain the 'modelView' uniform."<<endl;
+	if (!enabled){
+		delete gpuEvaluator;
+		gpuEvaluator = NULL;
+		reloadData();
+		return true;
 	}
-	lightPositionUniform = glGetUniformLocation(shaderProgram, "lightPosition");
-	if (lightPositionUniform == GL_INVALID_INDEX) {
-		cerr << "Shader did not contain the 'lightPosition' uniform."<<endl;
+	NURBSSurface *surface = dynamic_cast<NURBSSurface*>(nurbs);
+	if (surface == NULL){
+		cerr << "GPU evaluation is only supported for NURBSSurface" << endl;
+		return false;
 	}
-	colorUniform = glGetUniformLocation(shaderProgram, "color");
-	if (modelViewUniform == GL_INVALID_INDEX) {
-		cerr << "Shader did not contain the 'color' uniform."<<endl;
+	gpuEvaluator = new NURBSGPUEvaluator(surface);
+	if (!gpuEvaluator->isSupported()){
+		delete gpuEvaluator;
+		gpuEvaluator = NULL;
+		return false;
+	}
+	reloadData();
+	return true;
+}
+
+void NURBSRenderer::setupShader(){
+	shaderProgram = ShaderRegistry::getProgram("nurbs.vert",  "nurbs.frag", "fragColour");
+	GLuint perFrameBlock = glGetUniformBlockIndex(shaderProgram, "PerFrame");
+	if (perFrameBlock == GL_INVALID_INDEX) {
+		cerr << "Shader did not contain the 'PerFrame' uniform block."<<endl;
+	} else {
+		glUniformBlockBinding(shaderProgram, perFrameBlock, PER_FRAME_BINDING);
 	}
+	GLuint perObjectBlock = glGetUniformBlockIndex(shaderProgram, "PerObject");
+	if (perObjectBlock == GL_INVALID_INDEX) {
+		cerr << "Shader did not contain the 'PerObject' uniform block."<<endl;
+	} else {
+		glUniformBlockBinding(shaderProgram, perObjectBlock, PER_OBJECT_BINDING);
+	}
+	setupUniformBuffers();
 	positionAttribute = glGetAttribLocation(shaderProgram, "position");
 	if (positionAttribute == GL_INVALID_INDEX) {
 		cerr << "Shader did not contain the 'position' attribute." << endl;
@@ -91,64 +158,166 @@ vec4 NURBSRenderer::getColor() {
 	return color;
 }
 
+void NURBSRenderer::setupUniformBuffers(){
+	glGenBuffers(1, &perFrameBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, perFrameBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(PerFrameData), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, PER_FRAME_BINDING, perFrameBuffer);
+
+	// each object uses a range of the buffer (the offset must be a multiple of the alignment)
+	GLint alignment;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	perObjectStride = ((sizeof(PerObjectData) + alignment - 1) / alignment) * alignment;
+	glGenBuffers(1, &perObjectBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, perObjectBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, perObjectStride * PER_OBJECT_CAPACITY, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	perObjectOffset = 0;
+}
+
+void NURBSRenderer::beginFrame(const mat4 &projection, const vec4 &lightPosition){
+	invalidateStateCache();
+	if (perFrameBuffer == 0){
+		return;
+	}
+	PerFrameData frameData;
+	frameData.projection = projection;
+	frameData.lightPosition = lightPosition;
+	// the buffer binding may have been changed by other code
+	glBindBufferBase(GL_UNIFORM_BUFFER, PER_FRAME_BINDING, perFrameBuffer);
+	if (frameDataValid && memcmp(&frameData, &currentFrameData, sizeof(PerFrameData)) == 0){
+		return;
+	}
+	currentFrameData = frameData;
+	frameDataValid = true;
+	glBindBuffer(GL_UNIFORM_BUFFER, perFrameBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(PerFrameData), &frameData);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void NURBSRenderer::invalidateStateCache(){
+	programBound = false;
+	boundVao = 0;
+	boundPointSize = -1;
+}
+
+void NURBSRenderer::bindState(GLuint vao, const mat4 &modelView, const vec4 &color){
+	if (!programBound){
+		glUseProgram(shaderProgram);
+		programBound = true;
+	}
+	if (boundVao != vao){
+		glBindVertexArray(vao);
+		boundVao = vao;
+	}
+	PerObjectData objectData;
+	objectData.modelView = modelView;
+	objectData.color = color;
+	glBindBuffer(GL_UNIFORM_BUFFER, perObjectBuffer);
+	if (perObjectOffset + perObjectStride > perObjectStride * PER_OBJECT_CAPACITY){
+		// orphan the buffer - the driver allocates new storage while the old is still in use
+		glBufferData(GL_UNIFORM_BUFFER, perObjectStride * PER_OBJECT_CAPACITY, NULL, GL_STREAM_DRAW);
+		perObjectOffset = 0;
+	}
+	glBufferSubData(GL_UNIFORM_BUFFER, perObjectOffset, sizeof(PerObjectData), &objectData);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferRange(GL_UNIFORM_BUFFER, PER_OBJECT_BINDING, perObjectBuffer, perObjectOffset, sizeof(PerObjectData));
+	perObjectOffset += perObjectStride;
+}
+
 void NURBSRenderer::renderNormals(mat4 &projection, mat4 &modelView){
+	beginFrame(projection, frameDataValid ? currentFrameData.lightPosition : vec4(0));
+	renderNormals(modelView);
+}
+
+void NURBSRenderer::renderControlPoints(mat4 &projection, mat4 &modelView, float pointSize){
+	beginFrame(projection, frameDataValid ? currentFrameData.lightPosition : vec4(0));
+	renderControlPoints(modelView, pointSize);
+}
+
+void NURBSRenderer::render(mat4 &projection, mat4 &modelView, vec4 lightPosition){
+	beginFrame(projection, lightPosition);
+	render(modelView);
+}
+
+void NURBSRenderer::updateNormalsFromGPU(){
+	// the vertices only exist in the vertex buffer written using transform feedback
+	vector<NURBSVertex> meshData(vertexCount);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * sizeof(NURBSVertex), &meshData[0]);
+	vector<vec4> normals = createNormalLines(meshData);
+	glBindBuffer(GL_ARRAY_BUFFER, normalsVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(vec4), &normals[0], GL_DYNAMIC_DRAW);
+	PROFILE_BYTES_UPLOADED(normals.size() * sizeof(vec4));
+	normalCount = normals.size();
+	gpuNormalsValid = true;
+}
+
+void NURBSRenderer::renderNormals(const mat4 &modelView){
+	PROFILE_GPU_SCOPE("NURBSRenderer::renderNormals");
+	if (gpuEvaluator != NULL && vertexCount > 0 && !gpuNormalsValid){
+		updateNormalsFromGPU();
+	}
 	if (vaoControlPoints != 0){
-		glUseProgram(shaderProgram);
-		glBindVertexArray(vaoNormals);
 		vec4 black(0,0,0,1); // this disables any light
-		glUniform4fv(colorUniform,1,black);
-		glUniformMatrix4fv(projectionUniform, 1, GL_TRUE, projection);
-		glUniformMatrix4fv(modelViewUniform, 1, GL_TRUE, modelView);
+		bindState(vaoNormals, modelView, black);
 		glDrawArrays(GL_LINES,0, normalCount);
+		PROFILE_DRAW(normalCount);
 	}
 }
 
-void NURBSRenderer::renderControlPoints(mat4 &projection, mat4 &modelView, float pointSize){
+void NURBSRenderer::renderControlPoints(const mat4 &modelView, float pointSize){
+	PROFILE_GPU_SCOPE("NURBSRenderer::renderControlPoints");
 	if (vaoControlPoints != 0){
-		glUseProgram(shaderProgram);
-		glBindVertexArray(vaoControlPoints);
-		glPointSize(pointSize);
 		vec4 black(0,0,0,1); // this disables any light
-		glUniform4fv(colorUniform,1,black);
-		glUniformMatrix4fv(projectionUniform, 1, GL_TRUE, projection);
-		glUniformMatrix4fv(modelViewUniform, 1, GL_TRUE, modelView);
+		bindState(vaoControlPoints, modelView, black);
+		if (boundPointSize != pointSize){
+			glPointSize(pointSize);
+			boundPointSize = pointSize;
+		}
 		glDrawArrays(GL_POINTS,0, controlPointVertexCount);
+		PROFILE_DRAW(controlPointVertexCount);
 	}
 }
 
-void NURBSRenderer::render(mat4 &projection, mat4 &modelView, vec4 lightPosition){
+void NURBSRenderer::render(const mat4 &modelView){
+	PROFILE_GPU_SCOPE("NURBSRenderer::render");
 	if (vao != 0){
-		glUseProgram(shaderProgram);
-		glBindVertexArray(vao);
-		glUniform4fv(colorUniform,1,color);
-		glUniform4fv(lightPositionUniform, 1, lightPosition);
-		glUniformMatrix4fv(projectionUniform, 1, GL_TRUE, projection);
-		glUniformMatrix4fv(modelViewUniform, 1, GL_TRUE, modelView);
-		glDrawElements(primitiveType,meshDataIndices.size(),GL_UNSIGNED_INT,&(meshDataIndices[0]));
+		bindState(vao, modelView, color);
+		glDrawElements(primitiveType,meshDataIndices.size(),GL_UNSIGNED_INT,BUFFER_OFFSET(0));
+		PROFILE_DRAW(meshDataIndices.size());
 	}
 }
 
 void NURBSRenderer::reloadData(){
+	PROFILE_GPU_SCOPE("NURBSRenderer::reloadData");
+	invalidateStateCache(); // the vertex array objects are bound below
 	primitiveType = nurbs->getPrimitiveType();
-	vector<NURBSVertex> meshData = nurbs->getMeshData();
+	vector<NURBSVertex> meshData;
+	if (gpuEvaluator != NULL){
+		// only the control points and knot vectors are uploaded (the vertices are written below)
+		vertexCount = gpuEvaluator->getVertexCount();
+	} else {
+		meshData = nurbs->getMeshData();
+		vertexCount = meshData.size();
+	}
 	vector<vec4> controlPoints = nurbs->getControlPoints();
 	controlPointVertexCount = controlPoints.size();
 	for (int i=0;i<controlPointVertexCount;i++){ // set w to 1 when visualizing the control points
 		controlPoints[i].w = 1.0; 
 	}
 
-	vector<vec4> normals;
-	for (int i=0;i<meshData.size();i++){
-		normals.push_back(meshData[i].position);
-		normals.push_back(meshData[i].position + vec4(meshData[i].normal,0));
-	}
+	// with GPU evaluation the normals are read back when renderNormals() is used
+	vector<vec4> normals = createNormalLines(meshData);
 	normalCount = normals.size();
+	gpuNormalsValid = false;
 
-	vertexCount = meshData.size();
 	meshDataIndices = nurbs->getMeshDataIndices();
-	if (meshData.size() == 0){
+	if (vertexCount == 0){
 		return;
 	}
+	PROFILE_BYTES_UPLOADED(meshData.size() * sizeof(NURBSVertex) + meshDataIndices.size() * sizeof(GLuint) + 
+		controlPoints.size() * sizeof(vec4) + normals.size() * sizeof(vec4));
 	if (vao == 0){
 		// surface / curve
 		glGenVertexArrays(1, &vao);
@@ -156,7 +325,12 @@ void NURBSRenderer::reloadData(){
 	
 		glGenBuffers(1, &vertexBuffer);
 		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, meshData.size() * sizeof(NURBSVertex), meshData[0].position, GL_DYNAMIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(NURBSVertex), meshData.empty() ? NULL : &meshData[0], GL_DYNAMIC_DRAW);
+
+		// index buffer (client side index arrays are not supported in core profile)
+		glGenBuffers(1, &indexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshDataIndices.size() * sizeof(GLuint), &meshDataIndices[0], GL_DYNAMIC_DRAW);
 	
 		glEnableVertexAttribArray(positionAttribute);
 		glVertexAttribPointer(positionAttribute, 4, GL_FLOAT, GL_FALSE, sizeof(NURBSVertex), (const GLvoid *)0);
@@ -188,20 +362,33 @@ void NURBSRenderer::reloadData(){
 		glGenBuffers(1, &normalsVertexBuffer);
 		glBindBuffer(GL_ARRAY_BUFFER, normalsVertexBuffer);
 
-		glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(vec4), normals[0], GL_DYNAMIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(vec4), normals.empty() ? NULL : &normals[0], GL_DYNAMIC_DRAW);
 	
 		glEnableVertexAttribArray(positionAttribute);
 		glVertexAttribPointer(positionAttribute, 4, GL_FLOAT, GL_FALSE, sizeof(vec4), (const GLvoid *)0);
 
 	} else {
-		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, meshData.size() * sizeof(NURBSVertex), meshData[0].position);
+		if (!meshData.empty()){
+			glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, meshData.size() * sizeof(NURBSVertex), meshData[0].position);
+		}
 
-		glBindVertexArray(vaoControlPoints);
+		glBindVertexArray(vao);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshDataIndices.size() * sizeof(GLuint), &meshDataIndices[0], GL_DYNAMIC_DRAW);
+
+		// note that binding a vertex array object does not change the GL_ARRAY_BUFFER binding
+		glBindBuffer(GL_ARRAY_BUFFER, controlPointVertexBuffer);
 		glBufferSubData(GL_ARRAY_BUFFER, 0, controlPoints.size() * sizeof(vec4), controlPoints[0]);
 
-		glBindVertexArray(vaoNormals);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, normals.size() * sizeof(vec4), normals[0]);
+		if (!normals.empty()){
+			// (the size changes when switching from GPU evaluation)
+			glBindBuffer(GL_ARRAY_BUFFER, normalsVertexBuffer);
+			glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(vec4), normals[0], GL_DYNAMIC_DRAW);
+		}
+	}
+	if (gpuEvaluator != NULL){
+		gpuEvaluator->evaluate(vertexBuffer);
+		invalidateStateCache(); // the evaluator binds its own program and vertex array object
 	}
 }
 
@@ -28,7 +28,18 @@
 
 #include "NURBS.h"
 
+class NURBSGPUEvaluator;
+
 /// Renders a NURBS object
+/// The projection and light position are stored in a uniform buffer shared by all NURBSRenderers
+/// and the modelView and color are written to a per object uniform buffer. When rendering many
+/// objects use beginFrame() once per frame and the render methods without projection. 
+/// Example usage:
+///
+/// NURBSRenderer::beginFrame(projection, lightPosition);
+/// for each NURBSRenderer r {
+///     r->render(modelView);
+/// }
 class NURBSRenderer
 {
 public:
@@ -38,6 +49,14 @@ public:
 	/// reload the nurbs data. Must be called when the NURBS object has been modified.
 	void reloadData();
 
+	/// Evaluate the NURBS surface on the GPU (see NURBSGPUEvaluator) instead of using getMeshData() 
+	/// when reloading data. Only supported for NURBSSurface objects. When evaluated on the GPU
+	/// renderNormals() reads the vertices back (once after each reloadData()).
+	/// Returns false if not supported (the CPU evaluation is used instead)
+	bool setGPUEvaluation(bool enabled);
+
+	bool isGPUEvaluation() { return gpuEvaluator != NULL; }
+
 	/// Render the curve using the projection and modelView transforms
 	/// If curve, then the light position is ignored
 	void render(mat4 &projection, mat4 &modelView, vec4 lightPosition = vec4(0));
@@ -48,6 +67,23 @@ public:
 	/// Render the normals
 	void renderNormals(mat4 &projection, mat4 &modelView);
 
+	/// Set the per frame data (projection and light position) used by the following render calls
+	static void beginFrame(const mat4 &projection, const vec4 &lightPosition = vec4(0));
+
+	/// Render the curve using the projection and light position given in beginFrame()
+	void render(const mat4 &modelView);
+
+	/// Render the control points using the projection given in beginFrame()
+	void renderControlPoints(const mat4 &modelView, float pointSize = 5.0f);
+
+	/// Render the normals using the projection given in beginFrame()
+	void renderNormals(const mat4 &modelView);
+
+	/// The NURBSRenderer skips binding the shader and vertex array object if already bound. Must be called 
+	/// if other OpenGL code changes the program, vertex array object or point size between calls 
+	/// to the render methods (done automatically by beginFrame())
+	static void invalidateStateCache();
+
 	// set the color of the geometry
 	void setColor(vec4 color);
 
@@ -57,10 +93,17 @@ public:
 	int getVertexCount() { return vertexCount; }
 private:
 	void setupShader();
+	static void setupUniformBuffers();
+	// binds the shader and vao (unless already bound) and writes the per object data 
+	void bindState(GLuint vao, const mat4 &modelView, const vec4 &color);
+	// creates the normal lines from the vertices evaluated on the GPU
+	void updateNormalsFromGPU();
 	NURBS * nurbs;
+	NURBSGPUEvaluator * gpuEvaluator; // NULL when evaluated on the CPU
 
 	GLuint vao;
 	GLuint vertexBuffer;
+	GLuint indexBuffer;
 	int vertexCount;
 
 	GLuint vaoControlPoints;
@@ -70,14 +113,21 @@ private:
 	GLuint vaoNormals;
 	GLuint normalsVertexBuffer;
 	int normalCount;
+	bool gpuNormalsValid; // normals have been read back after the GPU evaluation
 	
 	vec4 color;
 
 	static GLuint shaderProgram;
-	static GLuint projectionUniform,
-		modelViewUniform,
-		lightPositionUniform,
-		colorUniform;
+
+	static GLuint perFrameBuffer;
+	static GLuint perObjectBuffer;
+	static GLint perObjectStride;
+	static GLint perObjectOffset;
+
+	// state cache
+	static bool programBound;
+	static GLuint boundVao;
+	static float boundPointSize;
 
 	static GLuint positionAttribute, 
 		normalAttribute, 
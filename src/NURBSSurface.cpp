@@ -144,6 +144,22 @@ int NURBSSurface::getDegreeV(){
 	return degreeV; 
 }
 
+std::vector<float> const &NURBSSurface::getKnotVectorU(){
+	return knotVectorU;
+}
+
+std::vector<float> const &NURBSSurface::getKnotVectorV(){
+	return knotVectorV;
+}
+
+int NURBSSurface::getDiscretizationU(){
+	return discretizationU;
+}
+
+int NURBSSurface::getDiscretizationV(){
+	return discretizationV;
+}
+
 std::vector<NURBSVertex> NURBSSurface::getMeshData(){
 	vector<NURBSVertex> res;
 	if (degreeU < 0 || degreeV < 0){
@@ -78,6 +78,14 @@ public:
 	int getDegreeU();
 	int getDegreeV();
 
+	// return the (normalized) knot vectors
+	std::vector<float> const &getKnotVectorU();
+	std::vector<float> const &getKnotVectorV();
+
+	// return the number of vertices in each direction of the tesselated mesh
+	int getDiscretizationU();
+	int getDiscretizationV();
+
 	// creates a tesselated mesh
 	std::vector<NURBSVertex> getMeshData();
 	std::vector<GLuint> getMeshDataIndices();
@@ -30,6 +30,9 @@
 #include <sstream>
 #include <string>
 #include <map>
+#include <algorithm>
+
+#include "Profiler.h"
 
 using namespace std;
 
@@ -93,8 +96,11 @@ struct TriangleString{
 	TriangleIndex v0;
 	TriangleIndex v1;
 	TriangleIndex v2;
+	int group;
+	int material;
 
-	TriangleString(string v0, string v1, string v2):v0(v0),v1(v1),v2(v2){
+	TriangleString(string v0, string v1, string v2, int group = 0, int material = -1)
+		:v0(v0),v1(v1),v2(v2),group(group),material(material){
 	}
 
 	TriangleIndex get(int index){
@@ -107,17 +113,101 @@ struct TriangleString{
 	}
 };
 
-bool loadObject(const char * filename, 
+// sort triangles by material first and object/group second
+bool compareTriangleMaterial(const TriangleString &lhs, const TriangleString &rhs){
+	return (lhs.material < rhs.material) ||
+		(lhs.material == rhs.material && lhs.group < rhs.group);
+}
+
+string getDirectory(const char * filename){
+	string path(filename);
+	size_t pos = path.find_last_of("/\\");
+	if (pos == string::npos){
+		return "";
+	}
+	return path.substr(0, pos+1);
+}
+
+// returns the rest of the line after the token (used for names which may contain spaces)
+string getName(istringstream &iss){
+	string name;
+	getline(iss, name);
+	size_t start = name.find_first_not_of(" \t\r");
+	if (start == string::npos){
+		return "";
+	}
+	size_t end = name.find_last_not_of(" \t\r");
+	return name.substr(start, end-start+1);
+}
+
+bool loadMaterials(const char * filename, vector<ObjMaterial> &outMaterials){
+	ifstream ifs ( filename , ifstream::in );
+	if (!ifs.is_open()){
+		cerr << "Cannot open material file " << filename << endl;
+		return false;
+	}
+	ObjMaterial *material = NULL;
+	char buffer[512];
+	while (ifs.good()){
+		ifs.getline(buffer,512);
+		
+		string line(buffer);
+		istringstream iss(line);
+		string token;
+		iss >> token;
+		if (token.compare("newmtl")==0){
+			outMaterials.push_back(ObjMaterial(getName(iss)));
+			material = &outMaterials.back();
+		} else if (material == NULL){
+			// ignore statements before the first material
+		} else if (token.compare("Ka")==0){
+			material->ambient = toVec3(iss);
+		} else if (token.compare("Kd")==0){
+			material->diffuse = toVec3(iss);
+		} else if (token.compare("Ks")==0){
+			material->specular = toVec3(iss);
+		} else if (token.compare("Ns")==0){
+			iss >> material->shininess;
+		} else if (token.compare("d")==0){
+			iss >> material->opacity;
+		} else if (token.compare("Tr")==0){
+			float transparency;
+			iss >> transparency;
+			material->opacity = 1.0f - transparency;
+		} else if (token.compare("map_Kd")==0){
+			material->diffuseMap = getName(iss);
+		}
+	}
+	ifs.close();
+	return true;
+}
+
+// shared implementation (submeshes and materials are only computed when not NULL)
+static bool loadObject(const char * filename, 
 	vector<vec3> &outPositions, 
 	vector<int> &outIndices,
+	vector<ObjSubmesh> *outSubmeshes,
+	vector<ObjMaterial> *outMaterials,
 	vector<vec3> &outNormal, 
 	vector<vec2> &outUv,
 	float scale){
+	PROFILE_SCOPE("loadObject");
 	
 	vector<vec3> positions;
 	vector<vec3> normals;
 	vector<vec2> uvs;
 
+	// object and group name of each group index
+	vector<pair<string, string> > groups;
+	groups.push_back(pair<string, string>("", ""));
+	int currentGroup = 0;
+	int currentMaterial = -1;
+	map<string,int> materialIndex;
+	if (outMaterials != NULL){
+		for (int i=0;i<outMaterials->size();i++){
+			materialIndex[(*outMaterials)[i].name] = i;
+		}
+	}
 
 	vector<TriangleString> triangles;
 	ifstream ifs ( filename , ifstream::in );
@@ -129,10 +219,39 @@ bool loadObject(const char * filename,
 		istringstream iss(line);
 		string token;
 		iss >> token;
-		if (token.compare("o")==0){
-			// does not support multiple objects
+		if (token.compare("o")==0 || token.compare("g")==0){
+			if (outSubmeshes != NULL){
+				pair<string, string> group = groups[currentGroup];
+				if (token.compare("o")==0){
+					group.first = getName(iss);
+					group.second = "";
+				} else {
+					group.second = getName(iss);
+				}
+				currentGroup = groups.size();
+				groups.push_back(group);
+			}
+		} else if (token.compare("mtllib")==0){
+			if (outMaterials != NULL){
+				int materialCount = outMaterials->size();
+				loadMaterials((getDirectory(filename) + getName(iss)).c_str(), *outMaterials);
+				for (int i=materialCount;i<outMaterials->size();i++){
+					materialIndex[(*outMaterials)[i].name] = i;
+				}
+			}
 		} else if (token.compare("usemtl")==0){
-			// does not support multiple materials
+			if (outMaterials != NULL){
+				string name = getName(iss);
+				map<string,int>::iterator found = materialIndex.find(name);
+				if (found != materialIndex.end()){
+					currentMaterial = found->second;
+				} else {
+					// material not found in any mtllib - use default material properties
+					currentMaterial = outMaterials->size();
+					materialIndex[name] = currentMaterial;
+					outMaterials->push_back(ObjMaterial(name));
+				}
+			}
 		} else if (token.compare("v")==0){
 			positions.push_back( toVec3(iss));
 		} else if (token.compare("vn")==0){
@@ -150,19 +269,38 @@ bool loadObject(const char * filename,
 			} while (iss);
 
 			// triangulate pologon
-			TriangleString triangle(polygon[0], polygon[1], polygon[2]);
+			TriangleString triangle(polygon[0], polygon[1], polygon[2], currentGroup, currentMaterial);
 			triangles.push_back(triangle);
 			for (int i=3;i<polygon.size();i++){
-				TriangleString triangle2(polygon[i-1], polygon[i], polygon[0]);
+				TriangleString triangle2(polygon[i-1], polygon[i], polygon[0], currentGroup, currentMaterial);
 				triangles.push_back(triangle2);
 			}
 		}
 	}
 	ifs.close();
 
+	if (outSubmeshes != NULL){
+		// make each material a contiguous range of triangles
+		stable_sort(triangles.begin(), triangles.end(), compareTriangleMaterial);
+	}
+
 	map<TriangleIndex,int> cache;
 	for (int i=0;i<triangles.size();i++){
 		TriangleString triangleString = triangles[i];
+		if (outSubmeshes != NULL){
+			if (i == 0 || 
+				triangleString.group != triangles[i-1].group || 
+				triangleString.material != triangles[i-1].material){
+				ObjSubmesh submesh;
+				submesh.objectName = groups[triangleString.group].first;
+				submesh.groupName = groups[triangleString.group].second;
+				submesh.material = triangleString.material;
+				submesh.firstIndex = outIndices.size();
+				submesh.indexCount = 0;
+				outSubmeshes->push_back(submesh);
+			}
+			outSubmeshes->back().indexCount += 3;
+		}
 		for (int j=0;j<3;j++){
 			TriangleIndex index = triangleString.get(j);
 			map<TriangleIndex,int>::iterator cachedIndex = cache.find(index);
@@ -171,11 +309,16 @@ bool loadObject(const char * filename,
 			} else {
 				int vertexIndex = outPositions.size();
 				outPositions.push_back(positions[index.position-1] * scale);
+				// keep normals and uvs aligned with positions if only some faces have them
 				if (index.normal != -1){
 					outNormal.push_back(normals[index.normal-1]);
+				} else if (normals.size() > 0){
+					outNormal.push_back(vec3(0,0,0));
 				}
 				if (index.uv != -1) {
 					outUv.push_back(uvs[index.uv-1]);
+				} else if (uvs.size() > 0){
+					outUv.push_back(vec2(0,0));
 				}
 				outIndices.push_back(vertexIndex);
 				cache[index] = vertexIndex;
@@ -188,6 +331,62 @@ bool loadObject(const char * filename,
 	return true;
 }
 
+bool loadObject(const char * filename, 
+	vector<vec3> &outPositions, 
+	vector<int> &outIndices,
+	vector<vec3> &outNormal, 
+	vector<vec2> &outUv,
+	float scale){
+	return loadObject(filename, outPositions, outIndices, NULL, NULL, outNormal, outUv, scale);
+}
+
+bool loadObject(const char * filename, 
+	vector<vec3> &outPositions, 
+	vector<int> &outIndices,
+	vector<ObjSubmesh> &outSubmeshes,
+	vector<ObjMaterial> &outMaterials,
+	vector<vec3> &outNormal, 
+	vector<vec2> &outUv,
+	float scale){
+	return loadObject(filename, outPositions, outIndices, &outSubmeshes, &outMaterials, outNormal, outUv, scale);
+}
+
+bool loadObject(const char * filename, 
+	vector<vec3> &outPositions, 
+	vector<int> &outIndices,
+	vector<vec3> &outNormal){
+	vector<vec2> uvs;
+	return loadObject(filename, outPositions, outIndices, NULL, NULL, outNormal, uvs, 1.0f);
+}
+
+bool loadObject(const char * filename, 
+	vector<vec3> &outPositions, 
+	vector<int> &outIndices){
+	vector<vec3> normals;
+	vector<vec2> uvs;
+	return loadObject(filename, outPositions, outIndices, NULL, NULL, normals, uvs, 1.0f);
+}
+
+bool loadObject(const char * filename, 
+	vector<vec3> &outPositions, 
+	vector<int> &outIndices,
+	vector<ObjSubmesh> &outSubmeshes,
+	vector<ObjMaterial> &outMaterials,
+	vector<vec3> &outNormal){
+	vector<vec2> uvs;
+	return loadObject(filename, outPositions, outIndices, &outSubmeshes, &outMaterials, outNormal, uvs, 1.0f);
+}
+
+bool loadObject(const char * filename, 
+	vector<vec3> &outPositions, 
+	vector<int> &outIndices,
+	vector<ObjSubmesh> &outSubmeshes,
+	vector<ObjMaterial> &outMaterials){
+	vector<vec3> normals;
+	vector<vec2> uvs;
+	return loadObject(filename, outPositions, outIndices, &outSubmeshes, &outMaterials, normals, uvs, 1.0f);
+}
+
 void printDebug(vector<vec3> &positions, vector<int> &indices){
 	for (int i=0;i<indices.size();i++){
 		cout << positions[indices[i]] <<" ";
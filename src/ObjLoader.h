@@ -27,16 +27,76 @@
 #define __OBJ_LOADER_H
 
 #include <vector>
+#include <string>
 #include "Angel.h"
 
+// Material read from a .mtl file (only the most common properties are supported)
+struct ObjMaterial {
+	std::string name;
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	float shininess;
+	float opacity;
+	std::string diffuseMap; // path of map_Kd relative to the .mtl file (empty if none)
+
+	ObjMaterial(std::string name = "")
+		:name(name), ambient(0,0,0), diffuse(0.8f,0.8f,0.8f), specular(0,0,0), shininess(0), opacity(1) {}
+};
+
+// A range of triangles in the index list sharing the same object/group and material.
+// Submeshes are sorted by material, so all submeshes using a material are adjacent and 
+// the material can be drawn with a single draw call covering all of them.
+struct ObjSubmesh {
+	std::string objectName; // name from the last 'o' statement
+	std::string groupName;  // name from the last 'g' statement
+	int material;           // index into the material list (-1 if no material is used)
+	int firstIndex;         // offset into the index list
+	int indexCount;         // number of indices (3 per triangle)
+};
+
 // Load an OBJ model into the out parameters.
 // Note only simple OBJ files are supported.
 bool loadObject(const char * filename, 
 	std::vector<vec3> &outPositions, 
 	std::vector<int> &outIndices,
-	std::vector<vec3> &outNormal = std::vector<vec3>(), 
-	std::vector<vec2> &outUv = std::vector<vec2>(),
+	std::vector<vec3> &outNormal, 
+	std::vector<vec2> &outUv,
 	float scale = 1.0f
 	);
+// (overloads instead of default arguments, since a temporary cannot be bound to a non-const reference)
+bool loadObject(const char * filename, 
+	std::vector<vec3> &outPositions, 
+	std::vector<int> &outIndices,
+	std::vector<vec3> &outNormal);
+bool loadObject(const char * filename, 
+	std::vector<vec3> &outPositions, 
+	std::vector<int> &outIndices);
+
+// Load an OBJ model including the submesh table and the materials referenced by 'mtllib'.
+// The triangles are sorted by material (and object within a material).
+bool loadObject(const char * filename, 
+	std::vector<vec3> &outPositions, 
+	std::vector<int> &outIndices,
+	std::vector<ObjSubmesh> &outSubmeshes,
+	std::vector<ObjMaterial> &outMaterials,
+	std::vector<vec3> &outNormal, 
+	std::vector<vec2> &outUv,
+	float scale = 1.0f
+	);
+bool loadObject(const char * filename, 
+	std::vector<vec3> &outPositions, 
+	std::vector<int> &outIndices,
+	std::vector<ObjSubmesh> &outSubmeshes,
+	std::vector<ObjMaterial> &outMaterials,
+	std::vector<vec3> &outNormal);
+bool loadObject(const char * filename, 
+	std::vector<vec3> &outPositions, 
+	std::vector<int> &outIndices,
+	std::vector<ObjSubmesh> &outSubmeshes,
+	std::vector<ObjMaterial> &outMaterials);
+
+// Load the materials of a .mtl file and append them to outMaterials
+bool loadMaterials(const char * filename, std::vector<ObjMaterial> &outMaterials);
 
 #endif
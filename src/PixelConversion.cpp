@@ -0,0 +1,230 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PixelConversion.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_CONVERSION_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(PIXEL_CONVERSION_X86) && defined(__GNUC__)
+#define TARGET(x) __attribute__((target(x)))
+#else
+#define TARGET(x)
+#endif
+
+#ifdef PIXEL_CONVERSION_X86
+static bool hasSSSE3(){
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+static bool hasAVX2(){
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	bool osSupport = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	__cpuidex(info, 7, 0);
+	return osSupport && (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static const bool useSSSE3 = hasSSSE3();
+static const bool useAVX2 = hasAVX2();
+
+TARGET("ssse3")
+static int convertRowBGRToRGBASSSE3(const unsigned char * src, unsigned char * dst, int width){
+	const __m128i shuffle = _mm_setr_epi8(2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1);
+	const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+	int x = 0;
+	// each iteration reads 16 bytes and writes 4 pixels
+	for (;x*3+16 <= width*3;x+=4){
+		__m128i bgr = _mm_loadu_si128((const __m128i *)(src + x*3));
+		__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(bgr, shuffle), alpha);
+		_mm_storeu_si128((__m128i *)(dst + x*4), rgba);
+	}
+	return x;
+}
+
+TARGET("ssse3")
+static int convertRowBGRAToRGBASSSE3(const unsigned char * src, unsigned char * dst, int width, bool keepAlpha){
+	const __m128i shuffle = _mm_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+	const __m128i alpha = _mm_set1_epi32(keepAlpha ? 0 : (int)0xff000000);
+	int x = 0;
+	for (;x+4 <= width;x+=4){
+		__m128i bgra = _mm_loadu_si128((const __m128i *)(src + x*4));
+		__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(bgra, shuffle), alpha);
+		_mm_storeu_si128((__m128i *)(dst + x*4), rgba);
+	}
+	return x;
+}
+
+TARGET("avx2")
+static int convertRowBGRAToRGBAAVX2(const unsigned char * src, unsigned char * dst, int width, bool keepAlpha){
+	const __m256i shuffle = _mm256_setr_epi8(2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15,
+		2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15);
+	const __m256i alpha = _mm256_set1_epi32(keepAlpha ? 0 : (int)0xff000000);
+	int x = 0;
+	for (;x+8 <= width;x+=8){
+		__m256i bgra = _mm256_loadu_si256((const __m256i *)(src + x*4));
+		__m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(bgra, shuffle), alpha);
+		_mm256_storeu_si256((__m256i *)(dst + x*4), rgba);
+	}
+	return x;
+}
+
+// SSE2 is part of x86-64 and always used
+TARGET("sse2")
+static int convertRowRGB565ToRGBASSE2(const unsigned char * src, unsigned char * dst, int width){
+	const __m128i mask5 = _mm_set1_epi16(0x1f);
+	const __m128i mask6 = _mm_set1_epi16(0x3f);
+	const __m128i alpha = _mm_set1_epi16(0xff);
+	int x = 0;
+	// each iteration converts 8 pixels
+	for (;x+8 <= width;x+=8){
+		__m128i pixels = _mm_loadu_si128((const __m128i *)(src + x*2));
+		__m128i r = _mm_and_si128(_mm_srli_epi16(pixels, 11), mask5);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(pixels, 5), mask6);
+		__m128i b = _mm_and_si128(pixels, mask5);
+		// expand to 8 bit by replicating the high bits
+		r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+		g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+		b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+		// interleave to RGBA bytes
+		__m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+		__m128i ba = _mm_or_si128(b, _mm_slli_epi16(alpha, 8));
+		_mm_storeu_si128((__m128i *)(dst + x*4), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(dst + x*4 + 16), _mm_unpackhi_epi16(rg, ba));
+	}
+	return x;
+}
+#endif
+
+void convertRowBGRToRGBA(const unsigned char * src, unsigned char * dst, int width){
+	int x = 0;
+#ifdef PIXEL_CONVERSION_X86
+	if (useSSSE3){
+		x = convertRowBGRToRGBASSSE3(src, dst, width);
+	}
+#endif
+	for (;x<width;x++){
+		dst[x*4]   = src[x*3+2];
+		dst[x*4+1] = src[x*3+1];
+		dst[x*4+2] = src[x*3];
+		dst[x*4+3] = 255;
+	}
+}
+
+void convertRowBGRAToRGBA(const unsigned char * src, unsigned char * dst, int width, bool keepAlpha){
+	int x = 0;
+#ifdef PIXEL_CONVERSION_X86
+	if (useAVX2){
+		x = convertRowBGRAToRGBAAVX2(src, dst, width, keepAlpha);
+	} else if (useSSSE3){
+		x = convertRowBGRAToRGBASSSE3(src, dst, width, keepAlpha);
+	}
+#endif
+	for (;x<width;x++){
+		dst[x*4]   = src[x*4+2];
+		dst[x*4+1] = src[x*4+1];
+		dst[x*4+2] = src[x*4];
+		dst[x*4+3] = keepAlpha ? src[x*4+3] : 255;
+	}
+}
+
+void convertRowRGB565ToRGBA(const unsigned char * src, unsigned char * dst, int width){
+	int x = 0;
+#ifdef PIXEL_CONVERSION_X86
+	x = convertRowRGB565ToRGBASSE2(src, dst, width);
+#endif
+	for (;x<width;x++){
+		unsigned int pixel = src[x*2] | (src[x*2+1] << 8);
+		unsigned int r = (pixel >> 11) & 0x1f;
+		unsigned int g = (pixel >> 5) & 0x3f;
+		unsigned int b = pixel & 0x1f;
+		dst[x*4]   = (r << 3) | (r >> 2);
+		dst[x*4+1] = (g << 2) | (g >> 4);
+		dst[x*4+2] = (b << 3) | (b >> 2);
+		dst[x*4+3] = 255;
+	}
+}
+
+void convertRowPaletteToRGBA(const unsigned char * src, unsigned char * dst, int width, const unsigned char * paletteRGBA){
+	// a table lookup per pixel - gathers are not faster for a 1 KB palette
+	for (int x=0;x<width;x++){
+		memcpy(dst + x*4, paletteRGBA + src[x]*4, 4);
+	}
+}
+
+// extract the masked channel (the mask must be contiguous) and scale it to 8 bit 
+// (a channel without a mask is missingValue)
+static unsigned char extractChannel(unsigned int pixel, unsigned int mask, unsigned char missingValue){
+	if (mask == 0){
+		return missingValue;
+	}
+	int shift = 0;
+	while (((mask >> shift) & 1) == 0){
+		shift++;
+	}
+	// 64 bit since value * 255 overflows for masks wider than 24 bits
+	unsigned long long maxValue = mask >> shift;
+	unsigned long long value = (pixel & mask) >> shift;
+	return (unsigned char)((value * 255 + maxValue/2) / maxValue);
+}
+
+void convertRowBitfieldsToRGBA(const unsigned char * src, unsigned char * dst, int width, int bytesPerPixel, const unsigned int * masksRGBA){
+	if (bytesPerPixel == 2 && masksRGBA[0] == 0xf800 && masksRGBA[1] == 0x07e0 && masksRGBA[2] == 0x001f && masksRGBA[3] == 0){
+		convertRowRGB565ToRGBA(src, dst, width);
+		return;
+	}
+	if (bytesPerPixel == 4 && masksRGBA[0] == 0x00ff0000 && masksRGBA[1] == 0x0000ff00 && masksRGBA[2] == 0x000000ff && 
+		(masksRGBA[3] == 0 || masksRGBA[3] == 0xff000000)){
+		convertRowBGRAToRGBA(src, dst, width, masksRGBA[3] != 0);
+		return;
+	}
+	for (int x=0;x<width;x++){
+		unsigned int pixel = src[x*bytesPerPixel] | (src[x*bytesPerPixel+1] << 8);
+		if (bytesPerPixel == 4){
+			pixel |= (src[x*4+2] << 16) | ((unsigned int)src[x*4+3] << 24);
+		}
+		for (int c=0;c<3;c++){
+			dst[x*4+c] = extractChannel(pixel, masksRGBA[c], 0);
+		}
+		dst[x*4+3] = extractChannel(pixel, masksRGBA[3], 255); // opaque without an alpha mask
+	}
+}
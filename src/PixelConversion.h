@@ -0,0 +1,49 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __PIXEL_CONVERSION_H
+#define __PIXEL_CONVERSION_H
+
+// Row conversion kernels from BMP pixel formats to RGBA8.
+// On x86 the kernels use SSSE3/AVX2 when supported by the CPU (detected at runtime)
+// and fall back to scalar code otherwise. Source and destination must not overlap.
+
+// 24 bit BGR to RGBA (alpha is 255)
+void convertRowBGRToRGBA(const unsigned char * src, unsigned char * dst, int width);
+
+// 32 bit BGRA to RGBA. If keepAlpha is false the alpha is set to 255 (BGRX)
+void convertRowBGRAToRGBA(const unsigned char * src, unsigned char * dst, int width, bool keepAlpha = true);
+
+// 16 bit little endian RGB565 to RGBA
+void convertRowRGB565ToRGBA(const unsigned char * src, unsigned char * dst, int width);
+
+// 8 bit palette indices to RGBA, the palette contains 256 colors in RGBA order
+void convertRowPaletteToRGBA(const unsigned char * src, unsigned char * dst, int width, const unsigned char * paletteRGBA);
+
+// 16 or 32 bit pixels with bit masks (BI_BITFIELDS) to RGBA. The masks must be contiguous
+// (up to 32 bits). A zero color mask gives 0 and a zero alpha mask gives alpha 255.
+void convertRowBitfieldsToRGBA(const unsigned char * src, unsigned char * dst, int width, int bytesPerPixel, const unsigned int * masksRGBA);
+
+#endif
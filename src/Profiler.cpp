@@ -0,0 +1,243 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Profiler.h"
+
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+
+using namespace std;
+
+std::atomic<bool> Profiler::enabled(false);
+bool Profiler::gpuTimersEnabled = true;
+bool Profiler::gpuTimerActive = false;
+std::vector<std::string> Profiler::scopeNames;
+std::vector<ProfilerScopeStats> Profiler::scopes;
+std::vector<std::pair<int, GLuint> > Profiler::queries;
+std::vector<GLuint> Profiler::freeQueries;
+std::vector<Profiler::PendingFrame> Profiler::pendingFrames;
+ProfilerFrame Profiler::currentFrame;
+ProfilerFrame Profiler::lastFrame;
+std::chrono::steady_clock::time_point Profiler::frameStart;
+ProfilerExportCallback Profiler::exportCallback = NULL;
+void *Profiler::exportUserData = NULL;
+
+namespace {
+	// CPU scopes may be used on other threads (e.g. loadObject)
+	mutex profilerMutex;
+
+	// frames waiting for GPU timer results before the oldest frame is read using a blocking read
+	const int MAX_PENDING_FRAMES = 4;
+
+	void resetCounters(ProfilerFrame &frame){
+		frame.drawCalls = 0;
+		frame.verticesDrawn = 0;
+		frame.bytesUploaded = 0;
+	}
+}
+
+void Profiler::setEnabled(bool enabled){
+	lock_guard<mutex> lock(profilerMutex);
+	if (enabled && !Profiler::enabled){
+		// start a new frame
+		for (unsigned int i = 0; i < scopes.size(); i++){
+			scopes[i].calls = 0;
+			scopes[i].cpuTimeMs = 0;
+			scopes[i].gpuTimeMs = -1;
+		}
+		resetCounters(currentFrame);
+		frameStart = chrono::steady_clock::now();
+	}
+	Profiler::enabled = enabled;
+}
+
+void Profiler::setExportCallback(ProfilerExportCallback callback, void *userData){
+	exportCallback = callback;
+	exportUserData = userData;
+}
+
+int Profiler::registerScope(const char *name){
+	lock_guard<mutex> lock(profilerMutex);
+	// scopes with the same name are counted together
+	for (unsigned int i = 0; i < scopeNames.size(); i++){
+		if (scopeNames[i] == name){
+			return i;
+		}
+	}
+	ProfilerScopeStats stats;
+	stats.name = name;
+	stats.calls = 0;
+	stats.cpuTimeMs = 0;
+	stats.gpuTimeMs = -1;
+	scopes.push_back(stats);
+	scopeNames.push_back(name);
+	return scopes.size() - 1;
+}
+
+void Profiler::addDraw(long long vertices){
+	lock_guard<mutex> lock(profilerMutex);
+	currentFrame.drawCalls++;
+	currentFrame.verticesDrawn += vertices;
+}
+
+void Profiler::addBytesUploaded(long long bytes){
+	lock_guard<mutex> lock(profilerMutex);
+	currentFrame.bytesUploaded += bytes;
+}
+
+bool Profiler::isGPUTimerSupported(){
+#ifdef GLEW_VERSION
+	// GL_TIME_ELAPSED requires OpenGL 3.3 or ARB_timer_query
+	if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query){
+		return false;
+	}
+#endif
+	return gpuTimersEnabled;
+}
+
+GLuint Profiler::beginGPUTimer(){
+	// nested GPU scopes are only measured on the CPU
+	if (gpuTimerActive || !isGPUTimerSupported()){
+		return 0;
+	}
+	GLuint query;
+	if (freeQueries.empty()){
+		glGenQueries(1, &query);
+	} else {
+		query = freeQueries.back();
+		freeQueries.pop_back();
+	}
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	gpuTimerActive = true;
+	return query;
+}
+
+void Profiler::endScope(int scopeId, double cpuTimeMs, GLuint query){
+	if (query != 0){
+		glEndQuery(GL_TIME_ELAPSED);
+		gpuTimerActive = false;
+	}
+	lock_guard<mutex> lock(profilerMutex);
+	ProfilerScopeStats &stats = scopes[scopeId];
+	stats.calls++;
+	stats.cpuTimeMs += cpuTimeMs;
+	if (query != 0){
+		stats.gpuTimeMs = 0; // added when the query result is available
+		queries.push_back(make_pair(scopeId, query));
+	}
+}
+
+void Profiler::endFrame(){
+	if (!enabled){
+		return;
+	}
+	PendingFrame pendingFrame;
+	{
+		lock_guard<mutex> lock(profilerMutex);
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		ProfilerFrame &frame = pendingFrame.frame;
+		frame = currentFrame;
+		frame.frameNumber = currentFrame.frameNumber + 1;
+		frame.frameTimeMs = chrono::duration<double, milli>(now - frameStart).count();
+		for (unsigned int i = 0; i < scopes.size(); i++){
+			if (scopes[i].calls > 0){
+				frame.scopes.push_back(scopes[i]);
+			}
+			scopes[i].calls = 0;
+			scopes[i].cpuTimeMs = 0;
+			scopes[i].gpuTimeMs = -1;
+		}
+		pendingFrame.queries.swap(queries);
+		currentFrame.frameNumber = frame.frameNumber;
+		resetCounters(currentFrame);
+		frameStart = now;
+	}
+	pendingFrames.push_back(pendingFrame);
+
+	// export the frames in order when the GPU timers are available
+	while (!pendingFrames.empty()){
+		bool wait = pendingFrames.size() > MAX_PENDING_FRAMES;
+		if (!resolveFrame(pendingFrames[0], wait)){
+			break;
+		}
+		exportFrame(pendingFrames[0].frame);
+		pendingFrames.erase(pendingFrames.begin());
+	}
+}
+
+bool Profiler::resolveFrame(PendingFrame &pendingFrame, bool wait){
+	vector<pair<int, GLuint> > &frameQueries = pendingFrame.queries;
+	if (frameQueries.empty()){
+		return true;
+	}
+	if (!wait){
+		// queries complete in order, so only the last needs to be checked
+		GLint available = 0;
+		glGetQueryObjectiv(frameQueries.back().second, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available){
+			return false;
+		}
+	}
+	vector<ProfilerScopeStats> &frameScopes = pendingFrame.frame.scopes;
+	for (unsigned int i = 0; i < frameQueries.size(); i++){
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(frameQueries[i].second, GL_QUERY_RESULT, &nanoseconds);
+		const string &name = scopeNames[frameQueries[i].first];
+		for (unsigned int j = 0; j < frameScopes.size(); j++){
+			if (frameScopes[j].name == name){
+				frameScopes[j].gpuTimeMs += nanoseconds / 1000000.0;
+				break;
+			}
+		}
+		freeQueries.push_back(frameQueries[i].second);
+	}
+	frameQueries.clear();
+	return true;
+}
+
+void Profiler::exportFrame(const ProfilerFrame &frame){
+	lastFrame = frame;
+	if (exportCallback != NULL){
+		exportCallback(frame, exportUserData);
+	}
+}
+
+void Profiler::printFrame(const ProfilerFrame &frame, void *userData){
+	cout << "Frame " << frame.frameNumber << ": " << fixed << setprecision(3) << frame.frameTimeMs << " ms, " 
+		<< frame.drawCalls << " draw calls, " << frame.verticesDrawn << " vertices, " 
+		<< frame.bytesUploaded << " bytes uploaded" << endl;
+	for (unsigned int i = 0; i < frame.scopes.size(); i++){
+		const ProfilerScopeStats &stats = frame.scopes[i];
+		cout << "  " << stats.name << ": " << stats.calls << " calls, CPU " << stats.cpuTimeMs << " ms";
+		if (stats.gpuTimeMs >= 0){
+			cout << ", GPU " << stats.gpuTimeMs << " ms";
+		}
+		cout << endl;
+	}
+	cout.unsetf(ios::floatfield);
+	cout << setprecision(6);
+}
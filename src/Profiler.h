@@ -0,0 +1,179 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include "Angel.h"
+
+// Timing of a named scope within a frame
+struct ProfilerScopeStats {
+	std::string name;
+	int calls;
+	double cpuTimeMs;
+	double gpuTimeMs; // measured using GL_TIME_ELAPSED queries (-1 if the scope has no GPU timer)
+};
+
+// Counters and timings of one frame (only scopes called in the frame are included)
+struct ProfilerFrame {
+	int frameNumber;
+	double frameTimeMs; // CPU time since the previous endFrame()
+	std::vector<ProfilerScopeStats> scopes;
+	int drawCalls;
+	long long verticesDrawn;
+	long long bytesUploaded; // buffer and texture data uploaded by the library
+};
+
+typedef void (*ProfilerExportCallback)(const ProfilerFrame &frame, void *userData);
+
+// Instrumentation of the library calls (NURBSRenderer, SelectBuffer, loadObject and the texture 
+// uploads). The timings and counters are collected per frame and passed to the export callback.
+// GPU timings are read asynchronously, so a frame is exported a few frames after endFrame() (the 
+// GPU time of nested GPU scopes is included in the outer scope only).
+// The profiler is disabled at runtime by default. When compiled with PROFILER_DISABLED defined 
+// the instrumentation macros are removed.
+// Example usage:
+//
+// void exportFrame(const ProfilerFrame &frame, void *userData){
+//     // e.g. send to a profiling tool
+// }
+// Profiler::setExportCallback(exportFrame); // or Profiler::printFrame
+// Profiler::setEnabled(true);
+// void display(){
+//     renderScene();
+//     glutSwapBuffers();
+//     Profiler::endFrame();
+// }
+// Own code can be instrumented as well:
+// void renderScene(){
+//     PROFILE_GPU_SCOPE("renderScene");
+//     ...
+// }
+class Profiler {
+public:
+	static void setEnabled(bool enabled);
+	static bool isEnabled() { return enabled; }
+	// GPU timers are enabled by default (if supported)
+	static void setGPUTimersEnabled(bool enabled) { gpuTimersEnabled = enabled; }
+	static void setExportCallback(ProfilerExportCallback callback, void *userData = NULL);
+	// ends the current frame. Must be called once per frame on the OpenGL thread
+	static void endFrame();
+	// returns the last exported frame
+	static const ProfilerFrame &getLastFrame() { return lastFrame; }
+	// prints the frame to cout (can be used as export callback)
+	static void printFrame(const ProfilerFrame &frame, void *userData = NULL);
+
+	// used by the PROFILE_ macros
+	static int registerScope(const char *name);
+	static void addDraw(long long vertices);
+	static void addBytesUploaded(long long bytes);
+	static GLuint beginGPUTimer();
+	static void endScope(int scopeId, double cpuTimeMs, GLuint query);
+private:
+	struct PendingFrame {
+		ProfilerFrame frame;
+		std::vector<std::pair<int, GLuint> > queries; // scope id and query
+	};
+	static bool isGPUTimerSupported();
+	static bool resolveFrame(PendingFrame &pendingFrame, bool wait);
+	static void exportFrame(const ProfilerFrame &frame);
+	static std::atomic<bool> enabled; // read on other threads by the CPU scopes and counters
+	static bool gpuTimersEnabled;
+	static bool gpuTimerActive; // only one GL_TIME_ELAPSED query can be active
+	static std::vector<std::string> scopeNames;
+	static std::vector<ProfilerScopeStats> scopes; // current frame (by scope id)
+	static std::vector<std::pair<int, GLuint> > queries; // current frame
+	static std::vector<GLuint> freeQueries;
+	static std::vector<PendingFrame> pendingFrames;
+	static ProfilerFrame currentFrame;
+	static ProfilerFrame lastFrame;
+	static std::chrono::steady_clock::time_point frameStart;
+	static ProfilerExportCallback exportCallback;
+	static void *exportUserData;
+};
+
+// Measures the CPU time (and optionally the GPU time) from construction to destruction
+class ProfilerScope {
+public:
+	ProfilerScope(int scopeId, bool gpuTimer)
+		:scopeId(scopeId), query(0), active(Profiler::isEnabled()) {
+		if (active){
+			if (gpuTimer){
+				query = Profiler::beginGPUTimer();
+			}
+			start = std::chrono::steady_clock::now();
+		}
+	}
+	~ProfilerScope(){
+		if (active){
+			double cpuTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			Profiler::endScope(scopeId, cpuTimeMs, query);
+		}
+	}
+private:
+	int scopeId;
+	GLuint query;
+	bool active;
+	std::chrono::steady_clock::time_point start;
+};
+
+#ifndef PROFILER_DISABLED
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+// CPU timer of the rest of the current scope
+#define PROFILE_SCOPE(name) \
+	static int PROFILER_CONCAT(profilerScopeId, __LINE__) = Profiler::registerScope(name); \
+	ProfilerScope PROFILER_CONCAT(profilerScope, __LINE__)(PROFILER_CONCAT(profilerScopeId, __LINE__), false)
+// CPU and GPU timer of the rest of the current scope (must be used on the OpenGL thread)
+#define PROFILE_GPU_SCOPE(name) \
+	static int PROFILER_CONCAT(profilerScopeId, __LINE__) = Profiler::registerScope(name); \
+	ProfilerScope PROFILER_CONCAT(profilerScope, __LINE__)(PROFILER_CONCAT(profilerScopeId, __LINE__), true)
+// CPU and GPU timer from PROFILE_GPU_BEGIN to PROFILE_END, used when the timed code spans
+// more than one function (scope is a ProfilerScope pointer, NULL when not timing)
+#define PROFILE_GPU_BEGIN(name, scope) do { \
+	static int profilerScopeId = Profiler::registerScope(name); \
+	delete scope; \
+	scope = Profiler::isEnabled() ? new ProfilerScope(profilerScopeId, true) : NULL; \
+} while (0)
+#define PROFILE_END(scope) do { delete scope; scope = NULL; } while (0)
+// counts a draw call
+#define PROFILE_DRAW(vertices) do { if (Profiler::isEnabled()) Profiler::addDraw(vertices); } while (0)
+// counts bytes uploaded to buffers or textures
+#define PROFILE_BYTES_UPLOADED(bytes) do { if (Profiler::isEnabled()) Profiler::addBytesUploaded(bytes); } while (0)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_GPU_BEGIN(name, scope) ((void)0)
+#define PROFILE_END(scope) ((void)0)
+#define PROFILE_DRAW(vertices) ((void)0)
+#define PROFILE_BYTES_UPLOADED(bytes) ((void)0)
+#endif
+
+#endif
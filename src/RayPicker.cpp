@@ -0,0 +1,490 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "RayPicker.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "MatrixUtil.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAY_PICKER_SSE
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+	const int SAH_BIN_COUNT = 16;
+	const int MAX_LEAF_SIZE = 4;
+	// leaves larger than this are always split (if the centroids can be separated)
+	const int MAX_SAH_LEAF_SIZE = 16;
+	const int MAX_STACK_SIZE = 128;
+
+	struct Bounds {
+		vec3 min;
+		vec3 max;
+		Bounds()
+		:min(FLT_MAX), max(-FLT_MAX){
+		}
+		void grow(const vec3 &p){
+			min = vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+			max = vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+		}
+		void grow(const Bounds &b){
+			grow(b.min);
+			grow(b.max);
+		}
+		float area() const {
+			if (min.x > max.x){
+				return 0;
+			}
+			vec3 e = max - min;
+			return e.x * e.y + e.y * e.z + e.z * e.x;
+		}
+	};
+}
+
+RayPicker::RayPicker()
+:dirty(false){
+}
+
+RayPicker::~RayPicker(){
+}
+
+void RayPicker::addTriangle(const vec3 &v0, const vec3 &v1, const vec3 &v2, int id, int primitiveId){
+	Triangle triangle = {v0, v1, v2, id, primitiveId};
+	triangles.push_back(triangle);
+	dirty = true;
+}
+
+static vec3 transformPoint(const mat4 &transform, const vec3 &p){
+	vec4 res = transform * vec4(p, 1.0f);
+	return vec3(res.x / res.w, res.y / res.w, res.z / res.w);
+}
+
+void RayPicker::addMesh(int id, const std::vector<vec3> &positions, const std::vector<int> &indices, const mat4 &transform){
+	vector<vec3> worldPositions(positions.size());
+	for (int i=0;i<positions.size();i++){
+		worldPositions[i] = transformPoint(transform, positions[i]);
+	}
+	for (int i=0;i+2<indices.size();i+=3){
+		addTriangle(worldPositions[indices[i]], worldPositions[indices[i+1]], worldPositions[indices[i+2]], id, i/3);
+	}
+}
+
+void RayPicker::addNURBS(int id, NURBS *nurbs, const mat4 &transform){
+	GLenum primitiveType = nurbs->getPrimitiveType();
+	if (primitiveType != GL_TRIANGLE_STRIP && primitiveType != GL_TRIANGLES){
+		cerr << "RayPicker::addNURBS() only NURBS surfaces can be picked" << endl;
+		return;
+	}
+	vector<NURBSVertex> meshData = nurbs->getMeshData();
+	vector<GLuint> indices = nurbs->getMeshDataIndices();
+	vector<vec3> worldPositions(meshData.size());
+	for (int i=0;i<meshData.size();i++){
+		const vec4 &p = meshData[i].position;
+		worldPositions[i] = transformPoint(transform, vec3(p.x, p.y, p.z) / p.w);
+	}
+	if (primitiveType == GL_TRIANGLES){
+		for (int i=0;i+2<indices.size();i+=3){
+			addTriangle(worldPositions[indices[i]], worldPositions[indices[i+1]], worldPositions[indices[i+2]], id, i/3);
+		}
+		return;
+	}
+	// triangle strip - primitive id counts the degenerate triangles too (like gl_PrimitiveID)
+	for (int i=2;i<indices.size();i++){
+		GLuint a = indices[i-2], b = indices[i-1], c = indices[i];
+		if (a == b || b == c || a == c){
+			continue;
+		}
+		addTriangle(worldPositions[a], worldPositions[b], worldPositions[c], id, i-2);
+	}
+}
+
+void RayPicker::clear(){
+	triangles.clear();
+	nodes.clear();
+	groups.clear();
+	dirty = false;
+}
+
+void RayPicker::createLeaf(BVHNode &node, const int *triangleIndices, int count){
+	node.leftOrFirst = groups.size();
+	node.count = (count + 3) / 4;
+	for (int i=0;i<count;i+=4){
+		TriangleGroup group;
+		for (int lane=0;lane<4;lane++){
+			if (i + lane < count){
+				const Triangle &t = triangles[triangleIndices[i + lane]];
+				vec3 edge1 = t.v1 - t.v0;
+				vec3 edge2 = t.v2 - t.v0;
+				for (int axis=0;axis<3;axis++){
+					group.v0[axis][lane] = t.v0[axis];
+					group.edge1[axis][lane] = edge1[axis];
+					group.edge2[axis][lane] = edge2[axis];
+				}
+				group.triangle[lane] = triangleIndices[i + lane];
+			} else {
+				// degenerate triangle (never hit)
+				for (int axis=0;axis<3;axis++){
+					group.v0[axis][lane] = 0;
+					group.edge1[axis][lane] = 0;
+					group.edge2[axis][lane] = 0;
+				}
+				group.triangle[lane] = -1;
+			}
+		}
+		groups.push_back(group);
+	}
+}
+
+void RayPicker::build(){
+	nodes.clear();
+	groups.clear();
+	dirty = false;
+	if (triangles.empty()){
+		return;
+	}
+	int triangleCount = triangles.size();
+	vector<Bounds> triangleBounds(triangleCount);
+	vector<vec3> centroids(triangleCount);
+	vector<int> order(triangleCount);
+	for (int i=0;i<triangleCount;i++){
+		triangleBounds[i].grow(triangles[i].v0);
+		triangleBounds[i].grow(triangles[i].v1);
+		triangleBounds[i].grow(triangles[i].v2);
+		centroids[i] = (triangles[i].v0 + triangles[i].v1 + triangles[i].v2) / 3.0f;
+		order[i] = i;
+	}
+	nodes.reserve(triangleCount * 2 / MAX_LEAF_SIZE + 1);
+
+	struct BuildTask {
+		int node;
+		int first;
+		int count;
+	};
+	vector<BuildTask> tasks;
+	BVHNode root = BVHNode();
+	nodes.push_back(root);
+	BuildTask rootTask = {0, 0, triangleCount};
+	tasks.push_back(rootTask);
+	while (!tasks.empty()){
+		BuildTask task = tasks.back();
+		tasks.pop_back();
+		Bounds bounds;
+		Bounds centroidBounds;
+		for (int i=task.first;i<task.first+task.count;i++){
+			bounds.grow(triangleBounds[order[i]]);
+			centroidBounds.grow(centroids[order[i]]);
+		}
+		BVHNode &node = nodes[task.node];
+		for (int axis=0;axis<3;axis++){
+			node.boundsMin[axis] = bounds.min[axis];
+			node.boundsMax[axis] = bounds.max[axis];
+		}
+		node.boundsMin[3] = 0;
+		node.boundsMax[3] = 0;
+		if (task.count <= MAX_LEAF_SIZE){
+			createLeaf(node, &order[task.first], task.count);
+			continue;
+		}
+
+		// find the best split using binned SAH
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		int bestBin = 0;
+		for (int axis=0;axis<3;axis++){
+			float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+			if (extent <= 0){
+				continue;
+			}
+			Bounds binBounds[SAH_BIN_COUNT];
+			int binCount[SAH_BIN_COUNT] = {0};
+			float binScale = SAH_BIN_COUNT / extent;
+			for (int i=task.first;i<task.first+task.count;i++){
+				int bin = min(SAH_BIN_COUNT - 1, (int)((centroids[order[i]][axis] - centroidBounds.min[axis]) * binScale));
+				binBounds[bin].grow(triangleBounds[order[i]]);
+				binCount[bin]++;
+			}
+			// sweep from the right to get the area and count of all right sides
+			float rightArea[SAH_BIN_COUNT];
+			int rightCount[SAH_BIN_COUNT];
+			Bounds right;
+			int count = 0;
+			for (int bin=SAH_BIN_COUNT-1;bin>0;bin--){
+				right.grow(binBounds[bin]);
+				count += binCount[bin];
+				rightArea[bin] = right.area();
+				rightCount[bin] = count;
+			}
+			Bounds left;
+			count = 0;
+			for (int bin=0;bin<SAH_BIN_COUNT-1;bin++){
+				left.grow(binBounds[bin]);
+				count += binCount[bin];
+				float cost = left.area() * count + rightArea[bin+1] * rightCount[bin+1];
+				if (count > 0 && rightCount[bin+1] > 0 && cost < bestCost){
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = bin;
+				}
+			}
+		}
+		float leafCost = bounds.area() * task.count;
+		if (bestAxis == -1 || (bestCost >= leafCost && task.count <= MAX_SAH_LEAF_SIZE)){
+			createLeaf(node, &order[task.first], task.count);
+			continue;
+		}
+		// partition the triangles
+		float binScale = SAH_BIN_COUNT / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+		int *begin = &order[task.first];
+		int *middle = partition(begin, begin + task.count, [&](int t){
+			int bin = min(SAH_BIN_COUNT - 1, (int)((centroids[t][bestAxis] - centroidBounds.min[bestAxis]) * binScale));
+			return bin <= bestBin;
+		});
+		int leftCount = middle - begin;
+
+		int leftChild = nodes.size();
+		node.leftOrFirst = leftChild;
+		node.count = 0;
+		BVHNode child = BVHNode();
+		nodes.push_back(child); // note: node reference is invalid after this
+		nodes.push_back(child);
+		BuildTask leftTask = {leftChild, task.first, leftCount};
+		BuildTask rightTask = {leftChild + 1, task.first + leftCount, task.count - leftCount};
+		tasks.push_back(leftTask);
+		tasks.push_back(rightTask);
+	}
+}
+
+#ifdef RAY_PICKER_SSE
+
+// slab test of the ray against the node bounds. Returns the entry distance or FLT_MAX if missed
+static inline float intersectBounds(const float *boundsMin, const float *boundsMax, __m128 origin, __m128 inverseDirection, float maxDistance){
+	__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(boundsMin), origin), inverseDirection);
+	__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(boundsMax), origin), inverseDirection);
+	__m128 tNear = _mm_min_ps(t1, t2);
+	__m128 tFar = _mm_max_ps(t1, t2);
+	// horizontal max / min of the x, y and z lanes
+	tNear = _mm_max_ss(tNear, _mm_max_ss(_mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1,1,1,1)), _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2,2,2,2))));
+	tFar = _mm_min_ss(tFar, _mm_min_ss(_mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1,1,1,1)), _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2,2,2,2))));
+	float entry = max(_mm_cvtss_f32(tNear), 0.0f);
+	float exit = min(_mm_cvtss_f32(tFar), maxDistance);
+	return entry <= exit ? entry : FLT_MAX;
+}
+
+// intersects the ray with four triangles (Moller-Trumbore). Returns the lane of the closest hit or -1
+static inline int intersectTriangles(const float (*v0)[4], const float (*edge1)[4], const float (*edge2)[4],
+	const vec3 &origin, const vec3 &direction, float &inOutDistance, float &outU, float &outV){
+	__m128 e1x = _mm_loadu_ps(edge1[0]), e1y = _mm_loadu_ps(edge1[1]), e1z = _mm_loadu_ps(edge1[2]);
+	__m128 e2x = _mm_loadu_ps(edge2[0]), e2y = _mm_loadu_ps(edge2[1]), e2z = _mm_loadu_ps(edge2[2]);
+	__m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+	// p = direction x edge2
+	__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+	__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+	__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+	__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+	__m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+	// s = origin - v0
+	__m128 sx = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(v0[0]));
+	__m128 sy = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_loadu_ps(v0[1]));
+	__m128 sz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(v0[2]));
+	__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+	// q = s x edge1
+	__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+	__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+	__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+	__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+	__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+	__m128 zero = _mm_setzero_ps();
+	__m128 absDet = _mm_max_ps(det, _mm_sub_ps(zero, det));
+	__m128 mask = _mm_cmpgt_ps(absDet, _mm_set1_ps(1e-12f));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+	mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, zero));
+	mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(inOutDistance)));
+	int hits = _mm_movemask_ps(mask);
+	if (hits == 0){
+		return -1;
+	}
+	float ts[4], us[4], vs[4];
+	_mm_storeu_ps(ts, t);
+	_mm_storeu_ps(us, u);
+	_mm_storeu_ps(vs, v);
+	int bestLane = -1;
+	for (int lane=0;lane<4;lane++){
+		if ((hits & (1 << lane)) && ts[lane] < inOutDistance){
+			inOutDistance = ts[lane];
+			outU = us[lane];
+			outV = vs[lane];
+			bestLane = lane;
+		}
+	}
+	return bestLane;
+}
+
+#else
+
+static inline float intersectBounds(const float *boundsMin, const float *boundsMax, const vec3 &origin, const vec3 &inverseDirection, float maxDistance){
+	float entry = 0;
+	float exit = maxDistance;
+	for (int axis=0;axis<3;axis++){
+		float t1 = (boundsMin[axis] - origin[axis]) * inverseDirection[axis];
+		float t2 = (boundsMax[axis] - origin[axis]) * inverseDirection[axis];
+		entry = max(entry, min(t1, t2));
+		exit = min(exit, max(t1, t2));
+	}
+	return entry <= exit ? entry : FLT_MAX;
+}
+
+static inline int intersectTriangles(const float (*v0)[4], const float (*edge1)[4], const float (*edge2)[4],
+	const vec3 &origin, const vec3 &direction, float &inOutDistance, float &outU, float &outV){
+	int bestLane = -1;
+	for (int lane=0;lane<4;lane++){
+		vec3 e1(edge1[0][lane], edge1[1][lane], edge1[2][lane]);
+		vec3 e2(edge2[0][lane], edge2[1][lane], edge2[2][lane]);
+		vec3 p = cross(direction, e2);
+		float det = dot(e1, p);
+		if (fabs(det) <= 1e-12f){
+			continue;
+		}
+		float inverseDet = 1.0f / det;
+		vec3 s = origin - vec3(v0[0][lane], v0[1][lane], v0[2][lane]);
+		float u = dot(s, p) * inverseDet;
+		vec3 q = cross(s, e1);
+		float v = dot(direction, q) * inverseDet;
+		float t = dot(e2, q) * inverseDet;
+		if (u >= 0 && v >= 0 && u + v <= 1 && t > 0 && t < inOutDistance){
+			inOutDistance = t;
+			outU = u;
+			outV = v;
+			bestLane = lane;
+		}
+	}
+	return bestLane;
+}
+
+#endif
+
+bool RayPicker::intersect(const vec3 &origin, const vec3 &direction, RayHit &outHit, float maxDistance){
+	if (dirty){
+		build();
+	}
+	if (nodes.empty()){
+		return false;
+	}
+	// avoid division by zero (infinity times zero is undefined in the slab test)
+	vec3 inverseDirection;
+	for (int axis=0;axis<3;axis++){
+		float d = direction[axis];
+		if (fabs(d) < 1e-20f){
+			d = d < 0 ? -1e-20f : 1e-20f;
+		}
+		inverseDirection[axis] = 1.0f / d;
+	}
+#ifdef RAY_PICKER_SSE
+	__m128 rayOrigin = _mm_setr_ps(origin.x, origin.y, origin.z, 0);
+	__m128 rayInverseDirection = _mm_setr_ps(inverseDirection.x, inverseDirection.y, inverseDirection.z, 0);
+#else
+	const vec3 &rayOrigin = origin;
+	const vec3 &rayInverseDirection = inverseDirection;
+#endif
+
+	float closest = maxDistance;
+	int closestTriangle = -1;
+	float closestU = 0, closestV = 0;
+	int stack[MAX_STACK_SIZE];
+	int stackSize = 0;
+	vector<int> overflowStack; // only used by very deep trees
+	int nodeIndex = 0;
+	if (intersectBounds(nodes[0].boundsMin, nodes[0].boundsMax, rayOrigin, rayInverseDirection, closest) == FLT_MAX){
+		return false;
+	}
+	while (true){
+		const BVHNode &node = nodes[nodeIndex];
+		if (node.count > 0){
+			for (int i=node.leftOrFirst;i<node.leftOrFirst+node.count;i++){
+				const TriangleGroup &group = groups[i];
+				int lane = intersectTriangles(group.v0, group.edge1, group.edge2, origin, direction, closest, closestU, closestV);
+				if (lane != -1){
+					closestTriangle = group.triangle[lane];
+				}
+			}
+		} else {
+			// visit the nearest child first
+			int left = node.leftOrFirst;
+			int right = node.leftOrFirst + 1;
+			float leftDistance = intersectBounds(nodes[left].boundsMin, nodes[left].boundsMax, rayOrigin, rayInverseDirection, closest);
+			float rightDistance = intersectBounds(nodes[right].boundsMin, nodes[right].boundsMax, rayOrigin, rayInverseDirection, closest);
+			if (leftDistance > rightDistance){
+				swap(left, right);
+				swap(leftDistance, rightDistance);
+			}
+			if (leftDistance != FLT_MAX){
+				if (rightDistance != FLT_MAX){
+					if (stackSize < MAX_STACK_SIZE){
+						stack[stackSize++] = right;
+					} else {
+						overflowStack.push_back(right);
+					}
+				}
+				nodeIndex = left;
+				continue;
+			}
+		}
+		if (!overflowStack.empty()){
+			nodeIndex = overflowStack.back();
+			overflowStack.pop_back();
+			continue;
+		}
+		if (stackSize == 0){
+			break;
+		}
+		nodeIndex = stack[--stackSize];
+	}
+	if (closestTriangle == -1){
+		return false;
+	}
+	const Triangle &triangle = triangles[closestTriangle];
+	outHit.id = triangle.id;
+	outHit.primitiveId = triangle.primitiveId;
+	outHit.distance = closest;
+	outHit.position = origin + direction * closest;
+	outHit.barycentric = vec3(1.0f - closestU - closestV, closestU, closestV);
+	return true;
+}
+
+bool RayPicker::pick(int x, int y, const mat4 &projection, const mat4 &modelView, const vec4 &viewport, RayHit &outHit){
+	// ray through the center of the pixel from the near plane to the far plane
+	vec3 nearPoint = unProject(vec3(x + 0.5f, y + 0.5f, 0.0f), projection, modelView, viewport);
+	vec3 farPoint = unProject(vec3(x + 0.5f, y + 0.5f, 1.0f), projection, modelView, viewport);
+	return intersect(nearPoint, farPoint - nearPoint, outHit, 1.0f);
+}
@@ -0,0 +1,106 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RAY_PICKER_H
+#define __RAY_PICKER_H
+
+#include <vector>
+#include <cfloat>
+#include "Angel.h"
+
+#include "NURBS.h"
+
+// Result of a ray intersection
+struct RayHit {
+	int id;             // object id (given when the mesh was added)
+	int primitiveId;    // triangle index in the mesh (same as gl_PrimitiveID when rendered)
+	float distance;     // ray parameter of the hit (position = origin + direction * distance)
+	vec3 position;      // hit position (world coordinates)
+	vec3 barycentric;   // weights of the three triangle vertices at the hit position
+};
+
+// Picking using ray casting on the CPU (an alternative to SelectBuffer which does not
+// need to render the scene). The triangles are stored in a bounding volume hierarchy
+// built using the surface area heuristic (SAH).
+// Example usage:
+//
+// RayPicker *picker = new RayPicker();
+// picker->addMesh(0, positions, indices, modelTransform); // e.g. data from loadObject
+// picker->addNURBS(1, nurbsSurface);
+// RayHit hit;
+// if (picker->pick(x, y, projection, view, vec4(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT), hit)){
+//     cout << "Found object " << hit.id << endl;
+// }
+class RayPicker {
+public:
+	RayPicker();
+	~RayPicker();
+	// adds an indexed triangle mesh (3 indices per triangle) transformed into world space
+	void addMesh(int id, const std::vector<vec3> &positions, const std::vector<int> &indices, const mat4 &transform = mat4());
+	// adds the tesselated mesh of a NURBS surface (curves are ignored)
+	void addNURBS(int id, NURBS *nurbs, const mat4 &transform = mat4());
+	// removes all meshes
+	void clear();
+	// builds the bounding volume hierarchy (done automatically on the first intersection after meshes are added)
+	void build();
+	// finds the closest triangle hit by the ray. Returns false if nothing is hit
+	bool intersect(const vec3 &origin, const vec3 &direction, RayHit &outHit, float maxDistance = FLT_MAX);
+	// finds the closest triangle in pixel x,y (window coordinates, origin in lower left corner)
+	bool pick(int x, int y, const mat4 &projection, const mat4 &modelView, const vec4 &viewport, RayHit &outHit);
+	int getTriangleCount() { return triangles.size(); }
+	int getNodeCount() { return nodes.size(); }
+private:
+	struct Triangle {
+		vec3 v0;
+		vec3 v1;
+		vec3 v2;
+		int id;
+		int primitiveId;
+	};
+	struct BVHNode {
+		float boundsMin[4];
+		float boundsMax[4];
+		// if count > 0 this is a leaf with count triangle groups starting at leftOrFirst
+		// otherwise the children are leftOrFirst and leftOrFirst+1
+		int leftOrFirst;
+		int count;
+	};
+	// four triangles stored as structure of arrays (vertex 0 and the two edges) for SIMD intersection
+	struct TriangleGroup {
+		float v0[3][4];
+		float edge1[3][4];
+		float edge2[3][4];
+		int triangle[4];
+	};
+	void addTriangle(const vec3 &v0, const vec3 &v1, const vec3 &v2, int id, int primitiveId);
+	void createLeaf(BVHNode &node, const int *triangleIndices, int count);
+	std::vector<Triangle> triangles;
+	std::vector<BVHNode> nodes;
+	std::vector<TriangleGroup> groups;
+	bool dirty;
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "RenderTargetPool.h"
+
+#include <iostream>
+
+using namespace std;
+
+RenderTargetPool::RenderTargetPool(int maxUnusedFrames)
+:maxUnusedFrames(maxUnusedFrames), frame(0){
+}
+
+RenderTargetPool::~RenderTargetPool(){
+    for (int i=0;i<renderTargets.size();i++){
+        deleteRenderTarget(renderTargets[i]);
+    }
+}
+
+FrameBufferObject *RenderTargetPool::acquire(GLuint width, GLuint height, bool floatingPoint, bool useDepthBuffer, int samples){
+    for (int i=0;i<renderTargets.size();i++){
+        RenderTarget &renderTarget = renderTargets[i];
+        if (!renderTarget.inUse && renderTarget.width == width && renderTarget.height == height &&
+            renderTarget.floatingPoint == floatingPoint && renderTarget.useDepthBuffer == useDepthBuffer && renderTarget.samples == samples){
+            renderTarget.inUse = true;
+            renderTarget.lastUsedFrame = frame;
+            return renderTarget.fbo;
+        }
+    }
+    RenderTarget renderTarget;
+    if (samples > 0){
+        renderTarget.fbo = new FrameBufferObject(width, height, samples, 1, floatingPoint, useDepthBuffer);
+    } else {
+        renderTarget.fbo = new FrameBufferObject(new Texture(width, height, floatingPoint), useDepthBuffer);
+    }
+    renderTarget.fbo->unbind();
+    renderTarget.width = width;
+    renderTarget.height = height;
+    renderTarget.floatingPoint = floatingPoint;
+    renderTarget.useDepthBuffer = useDepthBuffer;
+    renderTarget.samples = samples;
+    renderTarget.inUse = true;
+    renderTarget.lastUsedFrame = frame;
+    renderTargets.push_back(renderTarget);
+    return renderTarget.fbo;
+}
+
+void RenderTargetPool::release(FrameBufferObject *renderTarget){
+    for (int i=0;i<renderTargets.size();i++){
+        if (renderTargets[i].fbo == renderTarget){
+            renderTargets[i].inUse = false;
+            return;
+        }
+    }
+    cerr << "RenderTargetPool::release() render target not from this pool" << endl;
+}
+
+void RenderTargetPool::nextFrame(){
+    frame++;
+    for (int i = renderTargets.size() - 1; i >= 0; i--){
+        if (!renderTargets[i].inUse && frame - renderTargets[i].lastUsedFrame > maxUnusedFrames){
+            deleteRenderTarget(renderTargets[i]);
+            renderTargets.erase(renderTargets.begin() + i);
+        }
+    }
+}
+
+void RenderTargetPool::trim(){
+    for (int i = renderTargets.size() - 1; i >= 0; i--){
+        if (!renderTargets[i].inUse){
+            deleteRenderTarget(renderTargets[i]);
+            renderTargets.erase(renderTargets.begin() + i);
+        }
+    }
+}
+
+int RenderTargetPool::getInUseCount(){
+    int count = 0;
+    for (int i=0;i<renderTargets.size();i++){
+        if (renderTargets[i].inUse){
+            count++;
+        }
+    }
+    return count;
+}
+
+void RenderTargetPool::deleteRenderTarget(RenderTarget &renderTarget){
+    Texture *texture = renderTarget.fbo->getTexture();
+    delete renderTarget.fbo;
+    delete texture;
+}
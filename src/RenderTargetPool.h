@@ -0,0 +1,84 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RENDER_TARGET_POOL_H
+#define __RENDER_TARGET_POOL_H
+
+#include <vector>
+#include "Angel.h"
+
+#include "Texture.h"
+#include "FrameBufferObject.h"
+
+// Hands out framebuffer objects (with a color texture and optional depth buffer) and 
+// reuses them across render passes. A render target released in a pass can be acquired
+// again by a later pass in the same frame. Render targets not used for a number of frames
+// are deleted (e.g. targets with the old size after the window is resized).
+// The pool owns the framebuffer objects and their textures - never delete these.
+// Example usage:
+//
+// RenderTargetPool *pool = new RenderTargetPool();
+// // ----- Each frame
+// FrameBufferObject *blurTarget = pool->acquire(width, height);
+// blurTarget->bind();
+// // do your rendering
+// blurTarget->unbind();
+// // use blurTarget->getTexture()
+// pool->release(blurTarget);
+// pool->nextFrame();
+class RenderTargetPool {
+public:
+    RenderTargetPool(int maxUnusedFrames = 2);
+    ~RenderTargetPool();
+    // returns an unused render target with the given size and format or creates a new
+    // if samples > 0 a multisampled render target (without texture) is returned
+    FrameBufferObject *acquire(GLuint width, GLuint height, bool floatingPoint = false, bool useDepthBuffer = true, int samples = 0);
+    // returns the render target to the pool. The content may be overwritten by the next acquire
+    void release(FrameBufferObject *renderTarget);
+    // deletes render targets that has not been used for maxUnusedFrames
+    void nextFrame();
+    // deletes all render targets not in use
+    void trim();
+    int getRenderTargetCount() { return renderTargets.size(); }
+    int getInUseCount();
+private:
+    struct RenderTarget {
+        FrameBufferObject *fbo;
+        GLuint width;
+        GLuint height;
+        bool floatingPoint;
+        bool useDepthBuffer;
+        int samples;
+        bool inUse;
+        int lastUsedFrame;
+    };
+    void deleteRenderTarget(RenderTarget &renderTarget);
+    std::vector<RenderTarget> renderTargets;
+    int maxUnusedFrames;
+    int frame;
+};
+
+#endif
@@ -26,17 +26,47 @@
 #include "Select.h"
 
 #include <iostream>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstring>
+
+#include "MatrixUtil.h"
+#include "Profiler.h"
 
 using namespace std;
 
-SelectBuffer::SelectBuffer(int width, int height, GLuint colorUniform)
-:colorUniform(colorUniform), width(width), height(height)
+SelectBuffer::SelectBuffer(int width, int height, GLuint colorUniform, SelectBufferMode mode)
+:dirty(true), cpuCopy(false), cpuCopyValid(false), cpuDepthValid(false), renderPassScope(NULL), nextTicket(0), colorUniform(colorUniform), mode(mode), 
+width(width), height(height), storageWidth(width), storageHeight(height)
 {
 	buildTexture();
 	buildFrameBufferObject();
+#ifdef GLEW_VERSION
+	synchronousReadback = glFenceSync == NULL;
+#else
+	synchronousReadback = false;
+#endif
+	for (int i=0;i<PICK_REQUEST_COUNT;i++){
+		pickRequests[i].pixelBufferId = 0;
+		pickRequests[i].fence = 0;
+		pickRequests[i].ticket = -1;
+		pickRequests[i].id = -1;
+		pickRequests[i].primitiveId = -1;
+		pickRequests[i].depth = 1.0f;
+	}
 }
 
 SelectBuffer::~SelectBuffer(){
+	PROFILE_END(renderPassScope);
+	for (int i=0;i<PICK_REQUEST_COUNT;i++){
+		if (pickRequests[i].fence != 0){
+			glDeleteSync(pickRequests[i].fence);
+		}
+		if (pickRequests[i].pixelBufferId != 0){
+			glDeleteBuffers(1, &pickRequests[i].pixelBufferId);
+		}
+	}
 	glDeleteFramebuffers(1, &framebufferObjectId);
 	glDeleteRenderbuffers(1, &renderBufferId);
 	glDeleteTextures(1,  &textureId);
@@ -53,7 +83,12 @@ void SelectBuffer::buildTexture() {
 	GLuint internalFormat = GL_RGB;
     GLuint format = GL_RGB;
 	GLuint storageType = GL_UNSIGNED_BYTE;
-	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height,
+	if (mode == SELECT_BUFFER_INTEGER){
+		internalFormat = GL_RG32UI;
+		format = GL_RG_INTEGER;
+		storageType = GL_UNSIGNED_INT;
+	}
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, storageWidth, storageHeight,
             0, format, storageType, NULL);
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
@@ -62,7 +97,7 @@ void SelectBuffer::buildFrameBufferObject(){
 	glGenFramebuffers(1, &framebufferObjectId);
 	glGenRenderbuffers(1, &renderBufferId);
 	glBindRenderbuffer(GL_RENDERBUFFER, renderBufferId);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, storageWidth, storageHeight);
 	glBindFramebuffer(GL_FRAMEBUFFER, framebufferObjectId);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderBufferId);
@@ -100,26 +135,113 @@ std::string SelectBuffer::getFrameBufferStatusString(GLenum code){
 }
 
 void SelectBuffer::bind(){
+	// times the whole id pass including the rendering between bind() and release()
+	PROFILE_GPU_BEGIN("SelectBuffer::bind..release", renderPassScope);
 	glBindFramebuffer(GL_FRAMEBUFFER, framebufferObjectId);
 	glViewport(0,0,width,height);
-	glClearColor(0.0, 0.0, 0.0, 0.0);
-	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+	cpuCopyValid = false;
+	cpuDepthValid = false;
+	if (mode == SELECT_BUFFER_INTEGER){
+		// integer buffers cannot be cleared using glClearColor
+		GLuint clearValue[4] = {0,0,0,0};
+		glClearBufferuiv(GL_COLOR, 0, clearValue);
+		glClear(GL_DEPTH_BUFFER_BIT);
+	} else {
+		glClearColor(0.0, 0.0, 0.0, 0.0);
+		glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+	}
 }
 
 void SelectBuffer::release(){
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glFlush();
+	dirty = false;
+	PROFILE_END(renderPassScope);
 }
 
+void SelectBuffer::resize(int width, int height){
+	if (width == this->width && height == this->height){
+		return;
+	}
+	this->width = width;
+	this->height = height;
+	dirty = true;
+	cpuCopyValid = false;
+	cpuDepthValid = false;
+	if (width <= storageWidth && height <= storageHeight){
+		// reuse the storage when shrinking
+		return;
+	}
+	storageWidth = max(width, storageWidth);
+	storageHeight = max(height, storageHeight);
+	// the framebuffer object attachments refers to the same objects - only the storage is changed
+	glDeleteTextures(1, &textureId);
+	buildTexture();
+	glBindRenderbuffer(GL_RENDERBUFFER, renderBufferId);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, storageWidth, storageHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	GLint previousFramebuffer;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebufferObjectId);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer);
+}
+
+void SelectBuffer::setCpuCopy(bool cpuCopy){
+	this->cpuCopy = cpuCopy;
+	if (!cpuCopy){
+		cpuPixels.clear();
+		cpuDepth.clear();
+		cpuCopyValid = false;
+		cpuDepthValid = false;
+	}
+}
+
+void SelectBuffer::updateCpuCopy(){
+	int valuesPerPixel = getBytesPerPixel() / 4;
+	cpuPixels.resize(width * height * valuesPerPixel);
+	GLint previousReadFramebuffer;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferObjectId);
+	readPixels(0, 0, width, height, &cpuPixels[0]);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+	cpuCopyValid = true;
+}
+
+void SelectBuffer::readPixelsCached(int x, int y, int w, int h, GLvoid *buffer){
+	if (cpuCopy){
+		if (!cpuCopyValid){
+			updateCpuCopy();
+		}
+		int valuesPerPixel = getBytesPerPixel() / 4;
+		GLuint *dst = (GLuint*)buffer;
+		for (int row=0;row<h;row++){
+			const GLuint *src = &cpuPixels[((y + row) * width + x) * valuesPerPixel];
+			copy(src, src + w * valuesPerPixel, dst + row * w * valuesPerPixel);
+		}
+		return;
+	}
+	GLint previousReadFramebuffer;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferObjectId);
+	readPixels(x, y, w, h, buffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+}
+
+// colors are stored as round(c*255) - so the bytes must be divided by 255 to be exact
 vec4 encode(unsigned short id){
-	return vec4((id%256)/256.0f,(id/256)/256.0f,0,0);
+	return vec4((id%256)/255.0f,(id/256)/255.0f,0,0);
 }
 
 int decode(GLubyte *bytes){
 	return bytes[0]+bytes[1]*256;
 }
 
-void SelectBuffer::setId(unsigned short id){
+void SelectBuffer::setId(unsigned int id){
+	if (mode == SELECT_BUFFER_INTEGER){
+		glUniform1ui(colorUniform, id+1);
+		return;
+	}
 	if (id >= 65535){
 		cout << "Warning - id must be less than 65535" << endl;
 		id = 65535;
@@ -129,18 +251,363 @@ void SelectBuffer::setId(unsigned short id){
 	glUniform4fv(colorUniform, 1, encodedValue);
 }
 
+int SelectBuffer::getBytesPerPixel(){
+	return mode == SELECT_BUFFER_INTEGER ? 8 : 4;
+}
+
+void SelectBuffer::readPixels(int x, int y, int w, int h, GLvoid *buffer){
+	if (mode == SELECT_BUFFER_INTEGER){
+		glReadPixels(x, y, w, h, GL_RG_INTEGER, GL_UNSIGNED_INT, buffer);
+	} else {
+		glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+	}
+}
+
+unsigned int SelectBuffer::decodePixel(const GLvoid *pixel, int *outPrimitiveId){
+	if (mode == SELECT_BUFFER_INTEGER){
+		const GLuint *values = (const GLuint*)pixel;
+		if (outPrimitiveId != NULL){
+			*outPrimitiveId = values[0] != 0 ? (int)values[1] : -1;
+		}
+		return values[0];
+	}
+	if (outPrimitiveId != NULL){
+		*outPrimitiveId = -1;
+	}
+	return decode((GLubyte*)pixel);
+}
+
 int SelectBuffer::getId(int x, int y){
+	int primitiveId;
+	return getId(x, y, primitiveId);
+}
+
+int SelectBuffer::getId(int x, int y, int &outPrimitiveId){
+	PROFILE_SCOPE("SelectBuffer::getId");
+	outPrimitiveId = -1;
 	if (x>=width || y >= height || x<0 || y < 0){
 		return -1;
 	}
-	GLubyte pixelData[4] = {0,0,0,0};
-	glReadPixels(
+	GLuint pixelData[2] = {0,0};
+	readPixelsCached(
  		x,
  		y,
  		1,
  		1,
- 		GL_RGB,
- 		GL_UNSIGNED_BYTE,
 		pixelData);
-	return decode(pixelData)-1;
+	return (int)decodePixel(pixelData, &outPrimitiveId)-1;
+}
+
+bool SelectBuffer::readRegion(int &x, int &y, int &w, int &h, std::vector<unsigned int> &outIds){
+	int x0 = max(x, 0);
+	int y0 = max(y, 0);
+	int x1 = min(x + w, width);
+	int y1 = min(y + h, height);
+	if (x1 <= x0 || y1 <= y0){
+		return false;
+	}
+	x = x0;
+	y = y0;
+	w = x1 - x0;
+	h = y1 - y0;
+	int count = w * h;
+	// room for two 32 bit values per pixel in integer mode
+	outIds.resize(count * getBytesPerPixel() / 4);
+	readPixelsCached(x, y, w, h, &outIds[0]);
+
+	// decode in place (simple loops without branches which the compiler vectorizes)
+	if (mode == SELECT_BUFFER_INTEGER){
+		for (int i=0;i<count;i++){
+			outIds[i] = outIds[i*2];
+		}
+		outIds.resize(count);
+	} else {
+		GLubyte *bytes = (GLubyte*)&outIds[0];
+		for (int i=0;i<count;i++){
+			outIds[i] = bytes[i*4] | (bytes[i*4+1] << 8);
+		}
+	}
+	return true;
+}
+
+// adds the runs of equal ids in ids[0..count-1] to runs (neighbour pixels often have the same id)
+static void addIdRuns(const unsigned int *ids, int count, vector<pair<unsigned int, int> > &runs){
+	int i = 0;
+	while (i < count){
+		unsigned int id = ids[i];
+		int start = i;
+		while (i < count && ids[i] == id){
+			i++;
+		}
+		if (id != 0){
+			runs.push_back(make_pair(id, i - start));
+		}
+	}
+}
+
+// sorts the runs and merges them into one hit per id
+static vector<SelectHit> mergeIdRuns(vector<pair<unsigned int, int> > &runs){
+	vector<SelectHit> hits;
+	sort(runs.begin(), runs.end());
+	for (int i=0;i<runs.size();i++){
+		int id = runs[i].first - 1;
+		if (hits.empty() || hits.back().id != id){
+			SelectHit hit = {id, 0};
+			hits.push_back(hit);
+		}
+		hits.back().pixelCount += runs[i].second;
+	}
+	return hits;
+}
+
+void SelectBuffer::getIds(const std::vector<vec2> &points, std::vector<int> &outIds){
+	outIds.assign(points.size(), -1);
+	if (points.empty()){
+		return;
+	}
+	// read the bounding box of the points once
+	float minX = points[0].x, minY = points[0].y, maxX = points[0].x, maxY = points[0].y;
+	for (int i=1;i<points.size();i++){
+		minX = min(minX, points[i].x);
+		minY = min(minY, points[i].y);
+		maxX = max(maxX, points[i].x);
+		maxY = max(maxY, points[i].y);
+	}
+	int x = (int)floor(minX);
+	int y = (int)floor(minY);
+	int w = (int)floor(maxX) - x + 1;
+	int h = (int)floor(maxY) - y + 1;
+	vector<unsigned int> ids;
+	if (!readRegion(x, y, w, h, ids)){
+		return;
+	}
+	for (int i=0;i<points.size();i++){
+		int px = (int)floor(points[i].x) - x;
+		int py = (int)floor(points[i].y) - y;
+		if (px >= 0 && py >= 0 && px < w && py < h){
+			outIds[i] = ids[py * w + px] - 1;
+		}
+	}
+}
+
+std::vector<SelectHit> SelectBuffer::getIdsInRect(int x0, int y0, int x1, int y1){
+	int x = min(x0, x1);
+	int y = min(y0, y1);
+	int w = abs(x1 - x0) + 1;
+	int h = abs(y1 - y0) + 1;
+	vector<unsigned int> ids;
+	vector<pair<unsigned int, int> > runs;
+	if (readRegion(x, y, w, h, ids)){
+		addIdRuns(&ids[0], ids.size(), runs);
+	}
+	return mergeIdRuns(runs);
+}
+
+std::vector<SelectHit> SelectBuffer::getIdsInPolygon(const std::vector<vec2> &polygon){
+	vector<pair<unsigned int, int> > runs;
+	if (polygon.size() < 3){
+		return mergeIdRuns(runs);
+	}
+	float minX = polygon[0].x, minY = polygon[0].y, maxX = polygon[0].x, maxY = polygon[0].y;
+	for (int i=1;i<polygon.size();i++){
+		minX = min(minX, polygon[i].x);
+		minY = min(minY, polygon[i].y);
+		maxX = max(maxX, polygon[i].x);
+		maxY = max(maxY, polygon[i].y);
+	}
+	int x = (int)floor(minX);
+	int y = (int)floor(minY);
+	int w = (int)ceil(maxX) - x + 1;
+	int h = (int)ceil(maxY) - y + 1;
+	vector<unsigned int> ids;
+	if (!readRegion(x, y, w, h, ids)){
+		return mergeIdRuns(runs);
+	}
+	// scanline fill: pixel centers between pairs of edge crossings are inside
+	vector<float> crossings;
+	for (int row = 0; row < h; row++){
+		float sampleY = y + row + 0.5f;
+		crossings.clear();
+		for (int i=0;i<polygon.size();i++){
+			const vec2 &a = polygon[i];
+			const vec2 &b = polygon[(i+1) % polygon.size()];
+			if ((a.y <= sampleY) != (b.y <= sampleY)){
+				crossings.push_back(a.x + (sampleY - a.y) / (b.y - a.y) * (b.x - a.x));
+			}
+		}
+		sort(crossings.begin(), crossings.end());
+		for (int i=0;i+1<crossings.size();i+=2){
+			int start = max((int)ceil(crossings[i] - 0.5f) - x, 0);
+			int end = min((int)ceil(crossings[i+1] - 0.5f) - x, w);
+			if (end > start){
+				addIdRuns(&ids[row * w + start], end - start, runs);
+			}
+		}
+	}
+	return mergeIdRuns(runs);
+}
+
+int SelectBuffer::requestId(int x, int y){
+	if (x>=width || y >= height || x<0 || y < 0){
+		return -1;
+	}
+	int ticket = nextTicket++;
+	PickRequest &request = pickRequests[ticket % PICK_REQUEST_COUNT];
+	if (request.fence != 0){
+		glDeleteSync(request.fence);
+		request.fence = 0;
+	}
+	request.ticket = ticket;
+	request.x = x;
+	request.y = y;
+	
+	if (synchronousReadback || cpuCopy){
+		request.id = getId(x, y, request.primitiveId);
+		request.depth = getDepth(x, y);
+		return ticket;
+	}
+	GLint previousReadFramebuffer;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferObjectId);
+	if (request.pixelBufferId == 0){
+		glGenBuffers(1, &request.pixelBufferId);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, request.pixelBufferId);
+		glBufferData(GL_PIXEL_PACK_BUFFER, getBytesPerPixel() + sizeof(GLfloat), NULL, GL_STREAM_READ);
+	} else {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, request.pixelBufferId);
+	}
+	// the reads are queued after the rendering - glReadPixels returns without waiting.
+	// The id and the depth are stored in the same buffer and mapped together.
+	readPixels(x, y, 1, 1, 0);
+	glReadPixels(x, y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, BUFFER_OFFSET(getBytesPerPixel()));
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	request.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+	return ticket;
+}
+
+SelectBuffer::PickRequest *SelectBuffer::findPickRequest(int ticket){
+	if (ticket < 0){
+		return NULL;
+	}
+	PickRequest &request = pickRequests[ticket % PICK_REQUEST_COUNT];
+	if (request.ticket != ticket){
+		return NULL;
+	}
+	return &request;
+}
+
+bool SelectBuffer::completePickRequest(PickRequest &request, bool wait){
+	if (request.fence == 0){
+		return true;
+	}
+	if (wait){
+		GLenum res;
+		do {
+			res = glClientWaitSync(request.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (res == GL_TIMEOUT_EXPIRED);
+	} else if (glClientWaitSync(request.fence, 0, 0) == GL_TIMEOUT_EXPIRED){
+		return false;
+	}
+	glDeleteSync(request.fence);
+	request.fence = 0;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, request.pixelBufferId);
+	GLubyte *pixelData = (GLubyte*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, getBytesPerPixel() + sizeof(GLfloat), GL_MAP_READ_BIT);
+	if (pixelData != NULL){
+		request.id = (int)decodePixel(pixelData, &request.primitiveId)-1;
+		memcpy(&request.depth, pixelData + getBytesPerPixel(), sizeof(GLfloat));
+	} else {
+		request.id = -1;
+		request.primitiveId = -1;
+		request.depth = 1.0f;
+	}
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return true;
+}
+
+bool SelectBuffer::pollId(int ticket, int &outId){
+	PickRequest *request = findPickRequest(ticket);
+	if (request == NULL){
+		// ticket is invalid or too old
+		outId = -1;
+		return true;
+	}
+	if (!completePickRequest(*request, false)){
+		return false;
+	}
+	outId = request->id;
+	return true;
+}
+
+int SelectBuffer::waitId(int ticket){
+	PickRequest *request = findPickRequest(ticket);
+	if (request == NULL){
+		return -1;
+	}
+	completePickRequest(*request, true);
+	return request->id;
+}
+
+void SelectBuffer::createPick(const PickRequest &request, const mat4 &projection, const mat4 &modelView, SelectPick &outPick){
+	outPick.id = request.id;
+	outPick.primitiveId = request.primitiveId;
+	outPick.depth = request.depth;
+	outPick.position = unProject(vec3(request.x + 0.5f, request.y + 0.5f, request.depth), projection, modelView, vec4(0, 0, width, height));
+}
+
+bool SelectBuffer::pollPick(int ticket, const mat4 &projection, const mat4 &modelView, SelectPick &outPick){
+	PickRequest *request = findPickRequest(ticket);
+	if (request == NULL){
+		outPick.id = -1;
+		outPick.primitiveId = -1;
+		outPick.depth = 1.0f;
+		outPick.position = vec3(0,0,0);
+		return true;
+	}
+	if (!completePickRequest(*request, false)){
+		return false;
+	}
+	createPick(*request, projection, modelView, outPick);
+	return true;
+}
+
+bool SelectBuffer::getPick(int x, int y, const mat4 &projection, const mat4 &modelView, SelectPick &outPick){
+	int ticket = requestId(x, y);
+	PickRequest *request = findPickRequest(ticket);
+	if (request == NULL){
+		outPick.id = -1;
+		outPick.primitiveId = -1;
+		outPick.depth = 1.0f;
+		outPick.position = vec3(0,0,0);
+		return false;
+	}
+	completePickRequest(*request, true);
+	createPick(*request, projection, modelView, outPick);
+	return outPick.id >= 0;
+}
+
+float SelectBuffer::getDepth(int x, int y){
+	if (x>=width || y >= height || x<0 || y < 0){
+		return 1.0f;
+	}
+	if (cpuCopy){
+		if (!cpuDepthValid){
+			cpuDepth.resize(width * height);
+			GLint previousReadFramebuffer;
+			glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferObjectId);
+			glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, &cpuDepth[0]);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+			cpuDepthValid = true;
+		}
+		return cpuDepth[y * width + x];
+	}
+	GLfloat depth = 1.0f;
+	GLint previousReadFramebuffer;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferObjectId);
+	glReadPixels(x, y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousReadFramebuffer);
+	return depth;
 }
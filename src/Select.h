@@ -26,6 +26,34 @@
 #ifndef __SELECT_H
 #define __SELECT_H
 
+#include <vector>
+#include <string>
+#include "Angel.h"
+
+class ProfilerScope;
+
+enum SelectBufferMode {
+	// ids are encoded as colors in a RGB8 texture (up to 65535 ids). Uses a vec4 color uniform
+	SELECT_BUFFER_COLOR,
+	// object ids and primitive ids are written to a RG32UI texture. Uses a uint uniform 
+	// (see selectid.frag which writes the object id and gl_PrimitiveID)
+	SELECT_BUFFER_INTEGER
+};
+
+// Result of a depth aware pick
+struct SelectPick {
+	int id;            // object id (-1 if no object found)
+	int primitiveId;   // primitive id (only in SELECT_BUFFER_INTEGER mode, otherwise -1)
+	float depth;       // window depth (between 0 and 1, 1 if no object found)
+	vec3 position;     // world position (unprojected using projection and modelView)
+};
+
+// Object id found in a region and the number of pixels covered by the object
+struct SelectHit {
+	int id;
+	int pixelCount;
+};
+
 // Select buffer renders object ids into an offscreen buffer that can be used to find
 // which object is on a given pixel in screen coordinates.
 // The pseudocode for using the Select buffer is as follows:
@@ -53,33 +81,147 @@
 //
 // The important part of the pseudocode is to call selectBuffer->setId instead of the setting the color (and change the shader). 
 //
+// Asynchronous picking (avoids stalling the CPU until the GPU has rendered the select buffer):
+// void onMouseMove(int x, int y){
+//   selectBuffer->bind();
+//   renderScene(true);
+//   selectBuffer->release();
+//   pickTicket = selectBuffer->requestId(x, y);
+// }
+// void display(){
+//   int objectId;
+//   if (selectBuffer->pollId(pickTicket, objectId)){
+//     // use objectId (usually a frame after the request)
+//   }
+// }
+//
+// Cached picking (the scene is only rendered into the select buffer when something has changed):
+// selectBuffer->setCpuCopy(true); // picks are read from a copy in main memory
+// void onCameraOrSceneChanged(){
+//   selectBuffer->setDirty();
+// }
+// void onMouseMove(int x, int y){
+//   if (selectBuffer->isDirty()){
+//     selectBuffer->bind();
+//     renderScene(true);
+//     selectBuffer->release();
+//   }
+//   int objectId = selectBuffer->getId(x, y);
+// }
+//
+// Depth aware picking (finds the world position of the pixel):
+// SelectPick pick;
+// if (selectBuffer->getPick(x, y, projection, modelView, pick)){
+//   cout << "Found object " << pick.id << " at " << pick.position << endl;
+// }
+//
+// Primitive picking (finds the triangle of a mesh):
+// SelectBuffer *selectBuffer = new SelectBuffer(width, height, objectIdUniform, SELECT_BUFFER_INTEGER);
+// // render using selectid.frag
+// int primitiveId;
+// int objectId = selectBuffer->getId(x, y, primitiveId);
+//
 // Internally the Select buffer uses a FrameBufferObject that writes to a offscrene texture.
 // The select buffer needs a passthrough shader to be bound where the output
 // color (vec4) can be set using the colorUniform.
 class SelectBuffer {
 public:
-	SelectBuffer(int width, int height, GLuint colorUniform = 0);
+	SelectBuffer(int width, int height, GLuint colorUniform = 0, SelectBufferMode mode = SELECT_BUFFER_COLOR);
 	~SelectBuffer();
 	// binds the selectBuffer
 	void bind();
-	// releases the select buffer
+	// releases the select buffer (the content is now up to date - see isDirty())
 	void release();
+	// changes the size of the select buffer. The storage is only reallocated if it grows
+	void resize(int width, int height);
+	// mark the content as outdated (e.g. when the camera or the scene has changed)
+	void setDirty() { dirty = true; }
+	// returns true if the scene must be rendered to the select buffer before picking
+	bool isDirty() { return dirty; }
+	// if true the content is read once to main memory after it has been rendered, and all 
+	// getId(s) queries are answered from this copy without accessing OpenGL
+	void setCpuCopy(bool cpuCopy);
 	// set the id of the next object to be rendered (used only when select buffer is bound)
-	void setId(unsigned short id);
+	void setId(unsigned int id);
 	// returns the id of the pixel x,y (or -1 if no object found)
 	int getId(int x, int y);
+	// returns the id and primitive id of the pixel x,y (primitive id is -1 in SELECT_BUFFER_COLOR mode)
+	int getId(int x, int y, int &outPrimitiveId);
+	// finds the ids of all points (window coordinates) using a single read. outIds[i] is -1 if no object found
+	void getIds(const std::vector<vec2> &points, std::vector<int> &outIds);
+	// returns the unique ids inside the rectangle (x0,y0) to (x1,y1) (inclusive) sorted by id
+	std::vector<SelectHit> getIdsInRect(int x0, int y0, int x1, int y1);
+	// returns the unique ids inside the polygon (window coordinates, even-odd rule) sorted by id
+	std::vector<SelectHit> getIdsInPolygon(const std::vector<vec2> &polygon);
+	// starts an asynchronous read of the id at pixel x,y into a pixel buffer object. Returns a ticket used to 
+	// get the result using pollId or waitId (or -1 if x,y is outside the buffer). Only the latest 
+	// PICK_REQUEST_COUNT tickets are kept - older tickets return the id -1.
+	int requestId(int x, int y);
+	// returns true if the result of the ticket is ready. The id is written to outId
+	bool pollId(int ticket, int &outId);
+	// blocks until the result of the ticket is ready and returns the id
+	int waitId(int ticket);
+	// returns the id, window depth and world position of pixel x,y (the id and depth are read in one transfer).
+	// Returns false if no object is found
+	bool getPick(int x, int y, const mat4 &projection, const mat4 &modelView, SelectPick &outPick);
+	// asynchronous version of getPick (the ticket is created using requestId)
+	bool pollPick(int ticket, const mat4 &projection, const mat4 &modelView, SelectPick &outPick);
+	// returns the window depth of pixel x,y (1 if no object)
+	float getDepth(int x, int y);
+	// if true requestId reads the id immediately (default if fence sync objects are not supported)
+	void setSynchronousReadback(bool synchronous) { synchronousReadback = synchronous; }
 	// change the color uniform of the current bound shader (must be a vec4 uniform which is written directly to fragment shader output).
+	// In SELECT_BUFFER_INTEGER mode this must be the uint object id uniform.
 	void setColorUniform(GLuint colorUniform) { this->colorUniform = colorUniform; }
 private:
 	void buildTexture();
 	void buildFrameBufferObject();
 	std::string getFrameBufferStatusString(GLenum code);
+	// reads count pixels into buffer (or pixel buffer object) 
+	void readPixels(int x, int y, int w, int h, GLvoid *buffer);
+	int getBytesPerPixel();
+	// returns id+1 of the pixel (0 means no object)
+	unsigned int decodePixel(const GLvoid *pixel, int *outPrimitiveId = NULL);
+	// reads the region (clamped to the buffer) and returns the id+1 for each pixel (0 means no object)
+	bool readRegion(int &x, int &y, int &w, int &h, std::vector<unsigned int> &outIds);
+	// reads pixels from the framebuffer object (or the cpu copy if enabled)
+	void readPixelsCached(int x, int y, int w, int h, GLvoid *buffer);
+	void updateCpuCopy();
+	bool dirty;
+	bool cpuCopy;
+	bool cpuCopyValid;
+	bool cpuDepthValid;
+	ProfilerScope *renderPassScope; // timer of the id pass (from bind() to release())
+	std::vector<GLuint> cpuPixels;
+	std::vector<GLfloat> cpuDepth;
+	struct PickRequest {
+		GLuint pixelBufferId;
+		GLsync fence;
+		int ticket;
+		int x;
+		int y;
+		int id;
+		int primitiveId;
+		GLfloat depth;
+	};
+	static const int PICK_REQUEST_COUNT = 4;
+	PickRequest *findPickRequest(int ticket);
+	// reads the result of the request. Returns false if wait is false and the result is not ready
+	bool completePickRequest(PickRequest &request, bool wait);
+	void createPick(const PickRequest &request, const mat4 &projection, const mat4 &modelView, SelectPick &outPick);
+	PickRequest pickRequests[PICK_REQUEST_COUNT];
+	int nextTicket;
+	bool synchronousReadback;
 	GLuint framebufferObjectId;
 	GLuint renderBufferId;
 	GLuint textureId;
 	GLuint colorUniform;
+	SelectBufferMode mode;
 	int width;
 	int height;
+	// size of the allocated storage (may be larger than width, height)
+	int storageWidth;
+	int storageHeight;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,317 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ShaderRegistry.h"
+
+#include "NURBSGPUEvaluator.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+std::map<unsigned long long, GLuint> ShaderRegistry::programs;
+std::map<std::string, GLuint> ShaderRegistry::programFiles;
+std::string ShaderRegistry::binaryCacheDirectory;
+int ShaderRegistry::binaryCacheHits = 0;
+
+namespace {
+	const char PROGRAM_BINARY_MAGIC[4] = {'P','B','I','N'};
+
+	bool readFile(const char *filename, string &outContent){
+		ifstream file(filename, ios::in | ios::binary);
+		if (!file){
+			return false;
+		}
+		stringstream buffer;
+		buffer << file.rdbuf();
+		outContent = buffer.str();
+		return true;
+	}
+
+	// FNV-1a
+	unsigned long long hashString(const char *data, size_t length, unsigned long long hash = 14695981039346656037ULL){
+		for (size_t i=0;i<length;i++){
+			hash ^= (unsigned char)data[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	// identifies the driver (program binaries are only valid for the driver that created them)
+	unsigned long long getDriverHash(){
+		const char *vendor = (const char *)glGetString(GL_VENDOR);
+		const char *renderer = (const char *)glGetString(GL_RENDERER);
+		const char *version = (const char *)glGetString(GL_VERSION);
+		string driver = string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+		return hashString(driver.c_str(), driver.size());
+	}
+}
+
+unsigned long long ShaderRegistry::hashSource(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName, const std::vector<std::string> &varyings){
+	unsigned long long hash = hashString(vertexShaderSource.c_str(), vertexShaderSource.size() + 1);
+	hash = hashString(fragmentShaderSource.c_str(), fragmentShaderSource.size() + 1, hash);
+	hash = hashString(outputName, strlen(outputName) + 1, hash);
+	for (unsigned int i=0;i<varyings.size();i++){
+		hash = hashString(varyings[i].c_str(), varyings[i].size() + 1, hash);
+	}
+	return hash;
+}
+
+GLuint ShaderRegistry::getProgram(const char *vertexShaderFile, const char *fragmentShaderFile, const char *outputName){
+	string key = string(vertexShaderFile) + "|" + fragmentShaderFile + "|" + outputName;
+	map<string, GLuint>::iterator found = programFiles.find(key);
+	if (found != programFiles.end()){
+		return found->second;
+	}
+	string vertexShaderSource, fragmentShaderSource;
+	if (!readFile(vertexShaderFile, vertexShaderSource)){
+		cerr << "Failed to read " << vertexShaderFile << endl;
+		return 0;
+	}
+	if (!readFile(fragmentShaderFile, fragmentShaderSource)){
+		cerr << "Failed to read " << fragmentShaderFile << endl;
+		return 0;
+	}
+	GLuint program = getProgramFromSource(vertexShaderSource, fragmentShaderSource, outputName);
+	if (program != 0){
+		programFiles[key] = program;
+	}
+	return program;
+}
+
+GLuint ShaderRegistry::getTransformFeedbackProgram(const char *vertexShaderFile, const std::vector<std::string> &varyings){
+	string key = string(vertexShaderFile);
+	for (unsigned int i=0;i<varyings.size();i++){
+		key += "|" + varyings[i];
+	}
+	map<string, GLuint>::iterator found = programFiles.find(key);
+	if (found != programFiles.end()){
+		return found->second;
+	}
+	string vertexShaderSource;
+	if (!readFile(vertexShaderFile, vertexShaderSource)){
+		cerr << "Failed to read " << vertexShaderFile << endl;
+		return 0;
+	}
+	GLuint program = getProgramFromSource(vertexShaderSource, "", "", varyings);
+	if (program != 0){
+		programFiles[key] = program;
+	}
+	return program;
+}
+
+GLuint ShaderRegistry::getProgramFromSource(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName){
+	return getProgramFromSource(vertexShaderSource, fragmentShaderSource, outputName, vector<string>());
+}
+
+GLuint ShaderRegistry::getProgramFromSource(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName, const std::vector<std::string> &varyings){
+	unsigned long long hash = hashSource(vertexShaderSource, fragmentShaderSource, outputName, varyings);
+	map<unsigned long long, GLuint>::iterator found = programs.find(hash);
+	if (found != programs.end()){
+		return found->second;
+	}
+	GLuint program = loadProgramBinary(hash);
+	if (program != 0){
+		binaryCacheHits++;
+	} else {
+		program = linkProgram(vertexShaderSource, fragmentShaderSource, outputName, varyings);
+		if (program == 0){
+			return 0;
+		}
+		saveProgramBinary(hash, program);
+	}
+	programs[hash] = program;
+	return program;
+}
+
+GLuint ShaderRegistry::compileShader(GLenum type, const std::string &source){
+	GLuint shader = glCreateShader(type);
+	const GLchar *sourcePtr = source.c_str();
+	glShaderSource(shader, 1, &sourcePtr, NULL);
+	glCompileShader(shader);
+	GLint compiled;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (!compiled){
+		GLint logSize;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logSize);
+		vector<char> log(logSize + 1);
+		glGetShaderInfoLog(shader, logSize, NULL, &log[0]);
+		cerr << (type == GL_VERTEX_SHADER ? "Vertex" : "Fragment") << " shader failed to compile:" << endl << &log[0] << endl;
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+GLuint ShaderRegistry::linkProgram(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName, const std::vector<std::string> &varyings){
+	// transform feedback programs have no fragment shader
+	bool hasFragmentShader = !fragmentShaderSource.empty();
+	GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+	GLuint fragmentShader = hasFragmentShader ? compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource) : 0;
+	if (vertexShader == 0 || (hasFragmentShader && fragmentShader == 0)){
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return 0;
+	}
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	if (hasFragmentShader){
+		glAttachShader(program, fragmentShader);
+		glBindFragDataLocation(program, 0, outputName);
+	}
+	if (!varyings.empty()){
+		vector<const GLchar *> varyingNames;
+		for (unsigned int i=0;i<varyings.size();i++){
+			varyingNames.push_back(varyings[i].c_str());
+		}
+		glTransformFeedbackVaryings(program, varyingNames.size(), &varyingNames[0], GL_INTERLEAVED_ATTRIBS);
+	}
+	if (isBinaryCacheSupported()){
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(program);
+	// the shaders are deleted when the program is deleted
+	glDeleteShader(vertexShader);
+	if (hasFragmentShader){
+		glDeleteShader(fragmentShader);
+	}
+	GLint linked;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (!linked){
+		GLint logSize;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logSize);
+		vector<char> log(logSize + 1);
+		glGetProgramInfoLog(program, logSize, NULL, &log[0]);
+		cerr << "Shader program failed to link:" << endl << &log[0] << endl;
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+bool ShaderRegistry::isBinaryCacheSupported(){
+	if (binaryCacheDirectory.empty()){
+		return false;
+	}
+#ifdef GLEW_VERSION
+	if (glProgramBinary == NULL || glGetProgramBinary == NULL){
+		return false;
+	}
+#endif
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+std::string ShaderRegistry::getBinaryCacheFile(unsigned long long hash){
+	char filename[32];
+	sprintf(filename, "%016llx.bin", hash);
+	string path = binaryCacheDirectory;
+	if (path[path.size()-1] != '/' && path[path.size()-1] != '\\'){
+		path += "/";
+	}
+	return path + filename;
+}
+
+// Program binary file layout: magic 'PBIN', driver hash (8 bytes), binary format (4 bytes), 
+// binary length (4 bytes), binary
+GLuint ShaderRegistry::loadProgramBinary(unsigned long long hash){
+	if (!isBinaryCacheSupported()){
+		return 0;
+	}
+	FILE *file = fopen(getBinaryCacheFile(hash).c_str(), "rb");
+	if (file == NULL){
+		return 0;
+	}
+	char magic[4];
+	unsigned long long driverHash;
+	GLenum format;
+	GLint length;
+	vector<char> binary;
+	bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, PROGRAM_BINARY_MAGIC, 4) == 0 &&
+		fread(&driverHash, sizeof(driverHash), 1, file) == 1 && driverHash == getDriverHash() &&
+		fread(&format, sizeof(format), 1, file) == 1 &&
+		fread(&length, sizeof(length), 1, file) == 1 && length > 0;
+	if (ok){
+		binary.resize(length);
+		ok = fread(&binary[0], 1, length, file) == length;
+	}
+	fclose(file);
+	if (!ok){
+		return 0;
+	}
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, format, &binary[0], length);
+	GLint linked;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (!linked){
+		// binary is rejected (e.g. driver update) - the program is compiled from source instead
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+void ShaderRegistry::saveProgramBinary(unsigned long long hash, GLuint program){
+	if (!isBinaryCacheSupported()){
+		return;
+	}
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0){
+		return;
+	}
+	vector<char> binary(length);
+	GLenum format;
+	glGetProgramBinary(program, length, &length, &format, &binary[0]);
+	FILE *file = fopen(getBinaryCacheFile(hash).c_str(), "wb");
+	if (file == NULL){
+		cerr << "Cannot write program binary to " << getBinaryCacheFile(hash) << endl;
+		return;
+	}
+	unsigned long long driverHash = getDriverHash();
+	fwrite(PROGRAM_BINARY_MAGIC, 1, 4, file);
+	fwrite(&driverHash, sizeof(driverHash), 1, file);
+	fwrite(&format, sizeof(format), 1, file);
+	fwrite(&length, sizeof(length), 1, file);
+	fwrite(&binary[0], 1, length, file);
+	fclose(file);
+}
+
+void ShaderRegistry::setBinaryCacheDirectory(const std::string &directory){
+	binaryCacheDirectory = directory;
+}
+
+void ShaderRegistry::precompileLibraryShaders(){
+	getProgram("nurbs.vert", "nurbs.frag", "fragColour");
+	getProgram("fullscreentexture.vert", "fullscreentexture.frag", "fragColor");
+	NURBSGPUEvaluator::setupShader();
+}
@@ -0,0 +1,81 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SHADER_REGISTRY_H
+#define __SHADER_REGISTRY_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Angel.h"
+
+// Shared registry of shader programs (used instead of InitShader). Programs are compiled
+// once and shared - programs with the same source code (found using a hash of the source)
+// use the same program object. The programs live as long as the OpenGL context (the library
+// classes keep the program ids). Linked programs can be cached on disk as program binaries 
+// (if supported by the driver) which avoids compiling the shaders in later runs.
+// Example usage:
+//
+// // ---- Startup (e.g. while showing a loading screen)
+// ShaderRegistry::setBinaryCacheDirectory("shadercache");
+// ShaderRegistry::precompileLibraryShaders();
+// // ---- Setup
+// GLuint shaderProgram = ShaderRegistry::getProgram("const-shader.vert", "const-shader.frag", "fragColour");
+class ShaderRegistry {
+public:
+	// returns the program (or 0 if the shaders could not be compiled or linked).
+	// The program is owned by the registry and must not be deleted.
+	static GLuint getProgram(const char *vertexShaderFile, const char *fragmentShaderFile, const char *outputName);
+	// same as getProgram but using the source code instead of files
+	static GLuint getProgramFromSource(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName);
+	// returns a program without fragment shader where the vertex shader outputs (varyings) are captured 
+	// using transform feedback (interleaved in the order given)
+	static GLuint getTransformFeedbackProgram(const char *vertexShaderFile, const std::vector<std::string> &varyings);
+	// enables caching of program binaries in the directory (which must exist). Empty string disables the cache
+	static void setBinaryCacheDirectory(const std::string &directory);
+	// compiles the shaders used by the library (NURBSRenderer, NURBSGPUEvaluator and Texture)
+	static void precompileLibraryShaders();
+	static int getProgramCount() { return programs.size(); }
+	// number of programs loaded from the binary cache instead of compiled
+	static int getBinaryCacheHits() { return binaryCacheHits; }
+private:
+	static unsigned long long hashSource(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName, const std::vector<std::string> &varyings);
+	static GLuint getProgramFromSource(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName, const std::vector<std::string> &varyings);
+	static GLuint compileShader(GLenum type, const std::string &source);
+	static GLuint linkProgram(const std::string &vertexShaderSource, const std::string &fragmentShaderSource, const char *outputName, const std::vector<std::string> &varyings);
+	static bool isBinaryCacheSupported();
+	static std::string getBinaryCacheFile(unsigned long long hash);
+	static GLuint loadProgramBinary(unsigned long long hash);
+	static void saveProgramBinary(unsigned long long hash, GLuint program);
+	// programs by source hash
+	static std::map<unsigned long long, GLuint> programs;
+	// programs by file names (avoids reading the files again)
+	static std::map<std::string, GLuint> programFiles;
+	static std::string binaryCacheDirectory;
+	static int binaryCacheHits;
+};
+
+#endif
@@ -26,6 +26,8 @@
 
 #include "Texture.h"
 
+#include "ShaderRegistry.h"
+
 #include <iostream>
 
 using namespace std;
@@ -35,7 +37,7 @@ GLuint Texture::drawTextureVertexArrayObject = 0;
 GLuint Texture::drawTextureUniform = 0;
 
 Texture::Texture(GLuint width, GLuint height, bool floatingPoint, bool mipmaps )
-:width(width), height(height), floatingPoint(floatingPoint){
+:width(width), height(height), floatingPoint(floatingPoint), mipmaps(mipmaps){
     glGenTextures(1, &textureId);
     glBindTexture(GL_TEXTURE_2D, textureId);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -65,7 +67,7 @@ void Texture::renderFullscreenQuad(){
 }
 
 void Texture::setupRenderFullscreenQuad(){
-    drawTextureShader = InitShader("fullscreentexture.vert",  "fullscreentexture.frag", "fragColor");
+    drawTextureShader = ShaderRegistry::getProgram("fullscreentexture.vert",  "fullscreentexture.frag", "fragColor");
     GLuint positionAttributeLocation = glGetAttribLocation(drawTextureShader, "position");
     drawTextureUniform = glGetUniformLocation(drawTextureShader, "texture1");
     
@@ -40,12 +40,15 @@ public:
     GLuint getHeight() { return height; }
     GLuint getWidth() { return width; }
     GLuint getTextureId() { return textureId; }
+    bool isFloatingPoint() { return floatingPoint; }
+    bool hasMipmaps() { return mipmaps; }
     // Explicit generate mipmaps
     void generateMipmaps();
 private:
     void setupRenderFullscreenQuad();
     GLuint textureId;
     bool floatingPoint;
+    bool mipmaps;
     GLuint width;
     GLuint height;
     static GLuint drawTextureShader;
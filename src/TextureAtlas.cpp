@@ -0,0 +1,177 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TextureAtlas.h"
+#include "Profiler.h"
+
+#include <climits>
+
+using namespace std;
+
+RectanglePacker::RectanglePacker(int width, int height)
+:width(width), height(height){
+    clear();
+}
+
+void RectanglePacker::clear(){
+    skyline.clear();
+    SkylineNode node = {0, 0, width};
+    skyline.push_back(node);
+    usedArea = 0;
+}
+
+int RectanglePacker::fit(int index, int width, int height){
+    int x = skyline[index].x;
+    if (x + width > this->width){
+        return -1;
+    }
+    int y = 0;
+    int widthLeft = width;
+    while (widthLeft > 0){
+        y = max(y, skyline[index].y);
+        if (y + height > this->height){
+            return -1;
+        }
+        widthLeft -= skyline[index].width;
+        index++;
+    }
+    return y;
+}
+
+bool RectanglePacker::insert(int width, int height, int &outX, int &outY){
+    int bestIndex = -1;
+    int bestY = INT_MAX;
+    int bestWidth = INT_MAX;
+    for (int i=0;i<skyline.size();i++){
+        int y = fit(i, width, height);
+        if (y < 0){
+            continue;
+        }
+        // bottom-left: lowest position first, then narrowest node
+        if (y + height < bestY || (y + height == bestY && skyline[i].width < bestWidth)){
+            bestIndex = i;
+            bestY = y + height;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (bestIndex == -1){
+        return false;
+    }
+    outX = skyline[bestIndex].x;
+    outY = bestY - height;
+
+    SkylineNode node = {outX, bestY, width};
+    skyline.insert(skyline.begin() + bestIndex, node);
+    // shrink or remove the nodes covered by the new node
+    for (int i = bestIndex + 1; i < skyline.size(); i++){
+        int shrink = (skyline[i-1].x + skyline[i-1].width) - skyline[i].x;
+        if (shrink <= 0){
+            break;
+        }
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0){
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+        i--;
+    }
+    // merge neighbours with same height
+    for (int i = 0; i < (int)skyline.size() - 1; i++){
+        if (skyline[i].y == skyline[i+1].y){
+            skyline[i].width += skyline[i+1].width;
+            skyline.erase(skyline.begin() + i + 1);
+            i--;
+        }
+    }
+    usedArea += width * height;
+    return true;
+}
+
+float RectanglePacker::getOccupancy(){
+    return usedArea / (float)(width * height);
+}
+
+TextureAtlas::TextureAtlas(int width, int height, int layers, int padding)
+:width(width), height(height), layers(layers), padding(padding){
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    for (int i=0;i<layers;i++){
+        packers.push_back(RectanglePacker(width, height));
+    }
+}
+
+TextureAtlas::~TextureAtlas(){
+    glDeleteTextures(1, &textureId);
+}
+
+bool TextureAtlas::allocate(int width, int height, AtlasRegion &outRegion){
+    for (int layer = 0; layer < layers; layer++){
+        int x, y;
+        if (packers[layer].insert(width + padding, height + padding, x, y)){
+            outRegion.layer = layer;
+            outRegion.x = x;
+            outRegion.y = y;
+            outRegion.width = width;
+            outRegion.height = height;
+            outRegion.uvTransform = vec4(x / (float)this->width, y / (float)this->height,
+                width / (float)this->width, height / (float)this->height);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TextureAtlas::add(const unsigned char *rgba, int width, int height, AtlasRegion &outRegion){
+    if (!allocate(width, height, outRegion)){
+        return false;
+    }
+    update(outRegion, rgba);
+    return true;
+}
+
+void TextureAtlas::update(const AtlasRegion &region, const unsigned char *rgba){
+    PROFILE_GPU_SCOPE("TextureAtlas::update");
+    PROFILE_BYTES_UPLOADED(region.width * region.height * 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, region.x, region.y, region.layer, region.width, region.height, 1, 
+        GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureAtlas::clear(){
+    for (int i=0;i<layers;i++){
+        packers[i].clear();
+    }
+}
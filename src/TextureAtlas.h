@@ -0,0 +1,103 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __TEXTURE_ATLAS_H
+#define __TEXTURE_ATLAS_H
+
+#include <vector>
+#include "Angel.h"
+
+// Skyline bottom-left rectangle packer
+class RectanglePacker {
+public:
+    RectanglePacker(int width, int height);
+    // finds a position for a rectangle of the given size. Returns false if no space left
+    bool insert(int width, int height, int &outX, int &outY);
+    void clear();
+    // fraction of the area used
+    float getOccupancy();
+private:
+    struct SkylineNode {
+        int x;
+        int y;
+        int width;
+    };
+    // returns the y position if the rectangle fits at skyline node index or -1
+    int fit(int index, int width, int height);
+    std::vector<SkylineNode> skyline;
+    int width;
+    int height;
+    int usedArea;
+};
+
+// Location of an image in the texture atlas
+struct AtlasRegion {
+    int layer;
+    int x;
+    int y;
+    int width;
+    int height;
+    // maps uv in [0;1] into the atlas: atlasUV = uv * (z,w) + (x,y)
+    vec4 uvTransform;
+};
+
+// Packs many small RGBA images into the layers of a GL_TEXTURE_2D_ARRAY. This allows
+// rendering objects using different textures without rebinding textures. 
+// In the shader use a sampler2DArray and the uv transform and layer of the AtlasRegion.
+// Example usage:
+//
+// TextureAtlas *atlas = new TextureAtlas(1024, 1024, 4);
+// AtlasRegion region;
+// if (atlas->add(rgbaData, 64, 64, region)){
+//     // use region.uvTransform and region.layer
+// }
+class TextureAtlas {
+public:
+    // padding is the number of empty pixels between images (avoids bleeding with linear filtering)
+    TextureAtlas(int width = 1024, int height = 1024, int layers = 4, int padding = 1);
+    ~TextureAtlas();
+    // reserves space for an image without uploading data. Returns false if the atlas is full
+    bool allocate(int width, int height, AtlasRegion &outRegion);
+    // reserves space and uploads the RGBA image (8 bit per channel, first row is bottom row)
+    bool add(const unsigned char *rgba, int width, int height, AtlasRegion &outRegion);
+    // update content of an existing region
+    void update(const AtlasRegion &region, const unsigned char *rgba);
+    // removes all images (texture content is kept until overwritten)
+    void clear();
+    GLuint getTextureId() { return textureId; }
+    int getWidth() { return width; }
+    int getHeight() { return height; }
+    int getLayerCount() { return layers; }
+private:
+    GLuint textureId;
+    int width;
+    int height;
+    int layers;
+    int padding;
+    std::vector<RectanglePacker> packers;
+};
+
+#endif
@@ -24,77 +24,402 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "TextureLoader.h"
+#include "PixelConversion.h"
+#include "Profiler.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <memory.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 unsigned char * loadBMPRaw(const char * imagepath, unsigned int& outWidth, unsigned int& outHeight, bool flipY){
 	printf("Reading image %s\n", imagepath);
 	outWidth = -1;
 	outHeight = -1;
-	// Data read from the header of the BMP file
-	unsigned char header[54];
-	unsigned int dataPos;
-	unsigned int imageSize;
-	// Actual RGB data
-	unsigned char * data;
+	MappedBMP bmp(imagepath);
+	if (!bmp.isValid()){
+		return NULL;
+	}
+	if (bmp.getBitsPerPixel() != 24 || bmp.isCompressed()){
+		printf("Not a 24 bpp BMP file (use loadBMPRGBA)\n");
+		return NULL;
+	}
+	outWidth = bmp.getWidth();
+	outHeight = bmp.getHeight();
 
-	// Open the file
-	FILE * file = fopen(imagepath,"rb");
-	if (!file)							    {printf("Image could not be opened\n"); return NULL;}
+	// Copy each row once from the mapping into its final position. The rows keep the 4 byte 
+	// padding of the file (matches the default GL_UNPACK_ALIGNMENT)
+	ImageView view = bmp.getView(flipY);
+	int pixelRowSize = outWidth*3;
+	int rowSize = (pixelRowSize + 3) & ~3;
+	unsigned char * data = new unsigned char [rowSize*outHeight];
+	for (int i=0;i<outHeight;i++){
+		memcpy(data+rowSize*i, view.getRow(i), pixelRowSize);
+		memset(data+rowSize*i+pixelRowSize, 0, rowSize-pixelRowSize);
+	}
+	return data;
+}
 
-	// Read the header, i.e. the 54 first bytes
+enum {
+	BMP_RGB = 0,
+	BMP_RLE8 = 1,
+	BMP_BITFIELDS = 3,
+	BMP_ALPHABITFIELDS = 6
+};
 
-	// If less than 54 byes are read, problem
-	if ( fread(header, 1, 54, file)!=54 ){ 
-		printf("Not a correct BMP file\n");
-		return NULL;
+static int readInt32(const unsigned char * bytes){
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
+}
+
+// true if the set bits of the mask are contiguous (or the mask is zero)
+static bool isContiguousMask(unsigned int mask){
+	if (mask == 0){
+		return true;
+	}
+	while ((mask & 1) == 0){
+		mask >>= 1;
+	}
+	return (mask & ((unsigned long long)mask + 1)) == 0;
+}
+
+MappedBMP::MappedBMP(const char * imagepath)
+:mapping(NULL), mappingSize(0), pixelData(NULL), dataSize(0), bottomRow(NULL), stride(0), 
+	width(0), height(0), bitsPerPixel(0), compression(0), palette(NULL), paletteSize(0){
+	masks[0] = masks[1] = masks[2] = masks[3] = 0;
+#ifdef _WIN32
+	fileHandle = CreateFileA(imagepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	mappingHandle = NULL;
+	if (fileHandle == INVALID_HANDLE_VALUE){
+		fileHandle = NULL;
+		printf("Image could not be opened\n"); 
+		return;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	mappingSize = (size_t)fileSize.QuadPart;
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle != NULL){
+		mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	int file = open(imagepath, O_RDONLY);
+	if (file < 0){
+		printf("Image could not be opened\n"); 
+		return;
+	}
+	struct stat fileStat;
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0){
+		mappingSize = fileStat.st_size;
+		mapping = mmap(NULL, mappingSize, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping == MAP_FAILED){
+			mapping = NULL;
+		}
 	}
-	// A BMP files always begins with "BM"
-	if ( header[0]!='B' || header[1]!='M' ){
+	close(file); // the mapping stays valid after closing the file
+#endif
+	if (mapping == NULL){
+		printf("Image could not be mapped\n");
+		unmap();
+		return;
+	}
+	const unsigned char * header = (const unsigned char *)mapping;
+
+	// If less than 54 byes are mapped, problem
+	if (mappingSize < 54 || header[0]!='B' || header[1]!='M'){
 		printf("Not a correct BMP file\n");
-		return NULL;
+		unmap();
+		return;
 	}
-	// Make sure this is a 24bpp file
-	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    return NULL;}
-	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    return NULL;}
 
 	// Read the information about the image
-	dataPos    = *(int*)&(header[0x0A]);
-	imageSize  = *(int*)&(header[0x22]);
-	outWidth      = *(int*)&(header[0x12]);
-	outHeight     = *(int*)&(header[0x16]);
-
-	// Some BMP files are misformatted, guess missing information
-	if (imageSize==0)    imageSize=outWidth*outHeight*3; // 3 : one byte for each Red, Green and Blue component
+	unsigned int dataPos = readInt32(header+0x0A);
+	int headerSize = readInt32(header+0x0E);
+	int signedHeight = readInt32(header+0x16);
+	width = readInt32(header+0x12);
+	height = signedHeight < 0 ? -signedHeight : signedHeight;
+	bitsPerPixel = header[0x1C] | (header[0x1D] << 8);
+	compression = readInt32(header+0x1E);
 	if (dataPos==0)      dataPos=54; // The BMP header is done that way
 
-	// Create a buffer
-	data = new unsigned char [imageSize];
-
-	// Read the actual data from the file into the buffer
-	fread(data,1,imageSize,file);
-
-	// Everything is in memory now, the file wan be closed
-	fclose (file);
-
-	if (flipY){
-		// swap y-axis
-		unsigned char * tmpBuffer = new unsigned char[outWidth*3];
-		int size = outWidth*3;
-		for (int i=0;i<outHeight/2;i++){
-			// copy row i to tmp
-			memcpy_s(tmpBuffer,size,data+outWidth*3*i,size);
-			// copy row h-i-1 to i
-			memcpy_s(data+outWidth*3*i, size, data+outWidth*3*(outHeight-i-1), size);
-			// copy tmp to row h-i-1
-			memcpy_s(data+outWidth*3*(outHeight-i-1), size,tmpBuffer, size);
+	bool supported = (compression == BMP_RGB && (bitsPerPixel == 8 || bitsPerPixel == 16 || bitsPerPixel == 24 || bitsPerPixel == 32)) ||
+		(compression == BMP_RLE8 && bitsPerPixel == 8) ||
+		((compression == BMP_BITFIELDS || compression == BMP_ALPHABITFIELDS) && (bitsPerPixel == 16 || bitsPerPixel == 32));
+	if (!supported || dataPos >= mappingSize || headerSize < 40){
+		printf("Not a supported BMP file (%i bpp, compression %i)\n", bitsPerPixel, compression);
+		unmap();
+		return;
+	}
+
+	// color masks (the alpha mask is only present in the V3+ headers or for BI_ALPHABITFIELDS).
+	// BI_RGB files ignore the masks in the header (V4/V5 writers leave them zero)
+	if (compression == BMP_BITFIELDS || compression == BMP_ALPHABITFIELDS){
+		bool hasAlphaMask = headerSize >= 56 || compression == BMP_ALPHABITFIELDS;
+		for (int i=0;i<4;i++){
+			masks[i] = (i < 3 || hasAlphaMask) && 0x36 + i*4 + 4 <= mappingSize ? readInt32(header+0x36+i*4) : 0;
+			if (!isContiguousMask(masks[i])){
+				printf("Not a supported BMP file (color mask %x has holes)\n", masks[i]);
+				unmap();
+				return;
+			}
+		}
+	} else if (compression == BMP_RGB){
+		if (bitsPerPixel == 16){ // X1R5G5B5
+			masks[0] = 0x7c00; masks[1] = 0x03e0; masks[2] = 0x001f; masks[3] = 0;
+		} else if (bitsPerPixel == 32){ // BGRX
+			masks[0] = 0x00ff0000; masks[1] = 0x0000ff00; masks[2] = 0x000000ff; masks[3] = 0;
+		}
+	}
+
+	if (bitsPerPixel == 8){
+		unsigned int paletteOffset = 14 + headerSize;
+		if (headerSize == 40 && compression == BMP_BITFIELDS) paletteOffset += 12;
+		if (headerSize == 40 && compression == BMP_ALPHABITFIELDS) paletteOffset += 16;
+		paletteSize = readInt32(header+0x2E);
+		if (paletteSize <= 0 || paletteSize > 256) paletteSize = 256;
+		if (paletteOffset + paletteSize*4 > mappingSize){
+			paletteSize = paletteOffset < mappingSize ? (mappingSize - paletteOffset)/4 : 0;
 		}
-		delete [] tmpBuffer;
+		palette = header + paletteOffset;
 	}
 
+	dataSize = mappingSize - dataPos;
+	pixelData = header + dataPos;
+	if (compression == BMP_RLE8){
+		stride = 0;
+		bottomRow = NULL;
+		return;
+	}
+	// rows are padded to 4 bytes
+	int rowSize = (width*bitsPerPixel/8 + 3) & ~3;
+	// some BMP files are written without the padding of the last row
+	if (height > 0 && (size_t)rowSize*(height-1) + width*bitsPerPixel/8 > dataSize){
+		printf("Not a correct BMP file\n");
+		unmap();
+		return;
+	}
+	// rows are stored bottom-up unless the height is negative
+	if (signedHeight < 0){
+		bottomRow = pixelData + (ptrdiff_t)rowSize*(height-1);
+		stride = -rowSize;
+	} else {
+		bottomRow = pixelData;
+		stride = rowSize;
+	}
+}
+
+MappedBMP::~MappedBMP(){
+	unmap();
+}
+
+void MappedBMP::unmap(){
+#ifdef _WIN32
+	if (mapping != NULL){
+		UnmapViewOfFile(mapping);
+	}
+	if (mappingHandle != NULL){
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != NULL){
+		CloseHandle(fileHandle);
+	}
+	fileHandle = NULL;
+	mappingHandle = NULL;
+#else
+	if (mapping != NULL){
+		munmap(mapping, mappingSize);
+	}
+#endif
+	mapping = NULL;
+	pixelData = NULL;
+}
+
+ImageView MappedBMP::getView(bool flipY){
+	ImageView view;
+	view.width = width;
+	view.height = height;
+	view.bytesPerPixel = bitsPerPixel/8;
+	if (bottomRow == NULL){
+		view.data = NULL; // compressed
+		view.stride = 0;
+	} else if (flipY && height > 0){
+		view.data = bottomRow + (ptrdiff_t)stride*(height-1);
+		view.stride = -stride;
+	} else {
+		view.data = bottomRow;
+		view.stride = stride;
+	}
+	return view;
+}
+
+bool MappedBMP::hasAlpha(){
+	return bitsPerPixel == 32 && masks[3] != 0;
+}
+
+void MappedBMP::decodeRLE8(unsigned char * outIndices){
+	memset(outIndices, 0, width*height);
+	const unsigned char * rle = pixelData;
+	const unsigned char * end = pixelData + dataSize;
+	int x = 0;
+	int y = 0; // bottom-up
+	while (rle + 1 < end && y < height){
+		int count = rle[0];
+		int value = rle[1];
+		rle += 2;
+		if (count > 0){ // run of a single index
+			for (int i=0;i<count && x<width;i++){
+				outIndices[y*width + x++] = value;
+			}
+		} else if (value == 0){ // end of line
+			x = 0;
+			y++;
+		} else if (value == 1){ // end of bitmap
+			break;
+		} else if (value == 2){ // delta
+			if (rle + 1 >= end) break;
+			x += rle[0];
+			y += rle[1];
+			rle += 2;
+		} else { // absolute run padded to 16 bit
+			for (int i=0;i<value && rle + i < end;i++){
+				if (x < width && y < height){
+					outIndices[y*width + x] = rle[i];
+				}
+				x++;
+			}
+			rle += (value + 1) & ~1;
+		}
+	}
+}
+
+bool MappedBMP::decodeRGBA(unsigned char * outPixels, bool flipY){
+	if (!isValid()){
+		return false;
+	}
+	int rowSize = width*4;
+	unsigned char paletteRGBA[256*4];
+	if (bitsPerPixel == 8){
+		memset(paletteRGBA, 0, sizeof(paletteRGBA));
+		for (int i=0;i<paletteSize;i++){
+			paletteRGBA[i*4]   = palette[i*4+2];
+			paletteRGBA[i*4+1] = palette[i*4+1];
+			paletteRGBA[i*4+2] = palette[i*4];
+			paletteRGBA[i*4+3] = 255;
+		}
+	}
+	ImageView view = getView(flipY);
+	unsigned char * indices = NULL;
+	if (compression == BMP_RLE8){
+		indices = new unsigned char[width*height];
+		decodeRLE8(indices);
+		view.bytesPerPixel = 1;
+		view.stride = flipY ? -(int)width : width;
+		view.data = flipY && height > 0 ? indices + width*(height-1) : indices;
+	}
+	for (int y=0;y<height;y++){
+		const unsigned char * src = view.getRow(y);
+		unsigned char * dst = outPixels + rowSize*y;
+		if (bitsPerPixel == 8){
+			convertRowPaletteToRGBA(src, dst, width, paletteRGBA);
+		} else if (bitsPerPixel == 24){
+			convertRowBGRToRGBA(src, dst, width);
+		} else {
+			convertRowBitfieldsToRGBA(src, dst, width, bitsPerPixel/8, masks);
+		}
+	}
+	delete [] indices;
+	return true;
+}
+
+unsigned char * MappedBMP::decodeRGBA(bool flipY){
+	if (!isValid()){
+		return NULL;
+	}
+	unsigned char * data = new unsigned char[width*height*4];
+	decodeRGBA(data, flipY);
 	return data;
 }
 
+void MappedBMP::upload(GLenum target, GLint level, bool flipY){
+	if (!isValid()){
+		return;
+	}
+	PROFILE_GPU_SCOPE("MappedBMP::upload");
+	GLenum internalFormat = GL_RGBA8;
+	GLenum format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	bool direct = true; // upload directly from the mapping
+	if (compression == BMP_RGB && bitsPerPixel == 24){
+		internalFormat = GL_RGB8;
+		format = GL_BGR;
+	} else if (bitsPerPixel == 32 && masks[0] == 0x00ff0000 && masks[1] == 0x0000ff00 && masks[2] == 0x000000ff && 
+		(masks[3] == 0 || masks[3] == 0xff000000)){
+		internalFormat = hasAlpha() ? GL_RGBA8 : GL_RGB8; // the X channel is ignored
+		format = GL_BGRA;
+	} else if (bitsPerPixel == 16 && masks[0] == 0xf800 && masks[1] == 0x07e0 && masks[2] == 0x001f && masks[3] == 0){
+		internalFormat = GL_RGB8;
+		format = GL_RGB;
+		type = GL_UNSIGNED_SHORT_5_6_5;
+	} else {
+		direct = false;
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (!direct){
+		unsigned char * data = decodeRGBA(flipY);
+		PROFILE_BYTES_UPLOADED(width * height * 4);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexImage2D(target, level, internalFormat, width, height, 0, format, type, data);
+		delete [] data;
+		return;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // BMP rows are padded to 4 bytes
+	ImageView view = getView(flipY);
+	PROFILE_BYTES_UPLOADED(abs(view.stride) * height);
+	if (view.stride > 0){
+		glTexImage2D(target, level, internalFormat, width, height, 0, format, type, view.data);
+		return;
+	}
+	// OpenGL has no negative row length, so the rows are copied in reverse order into a pixel 
+	// buffer object (one pass) and uploaded with a single call
+	int rowSize = -view.stride;
+	int pixelRowSize = width * view.bytesPerPixel;
+	GLuint pixelBuffer;
+	glGenBuffers(1, &pixelBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, rowSize * height, NULL, GL_STREAM_DRAW);
+	unsigned char * rows = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, rowSize * height, 
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (rows != NULL){
+		for (int i=0;i<height;i++){
+			memcpy(rows + i * rowSize, view.getRow(i), pixelRowSize); // the last row in the file may be unpadded
+		}
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glTexImage2D(target, level, internalFormat, width, height, 0, format, type, NULL);
+	} else {
+		printf("Could not map the pixel buffer\n");
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glDeleteBuffers(1, &pixelBuffer);
+}
+
+unsigned char * loadBMPRGBA(const char * imagepath, unsigned int& outWidth, unsigned int& outHeight, bool flipY){
+	printf("Reading image %s\n", imagepath);
+	outWidth = -1;
+	outHeight = -1;
+	MappedBMP bmp(imagepath);
+	if (!bmp.isValid()){
+		return NULL;
+	}
+	outWidth = bmp.getWidth();
+	outHeight = bmp.getHeight();
+	return bmp.decodeRGBA(flipY);
+}
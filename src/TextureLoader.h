@@ -27,10 +27,14 @@
 #ifndef __TEXTURE_LOADER_H
 #define __TEXTURE_LOADER_H
 
+#include <stddef.h>
+#include "Angel.h"
+
 // Based on http://www.opengl-tutorial.org/beginners-tutorials/tutorial-5-a-textured-cube/
 
 
 /// The returned char* must be deleted by the calling function.
+/// The rows are padded to 4 bytes (as in the BMP file and the default GL_UNPACK_ALIGNMENT).
 ///
 /// Example usage:
 ///	unsigned int width, height;
@@ -58,4 +62,85 @@
 /// delete[] data;
 unsigned char * loadBMPRaw(const char * imagepath, unsigned int& outWidth, unsigned int& outHeight, bool flipY = true);
 
+/// Loads 8 bit (palettized or RLE8), 16 bit (555, 565 or bitfields), 24 bit and 32 bit BMP 
+/// files and converts the pixels to RGBA (4 bytes per pixel).
+/// The returned char* must be deleted by the calling function.
+///
+/// Example usage:
+///	unsigned int width, height;
+///	unsigned char * data = loadBMPRGBA(imagepath, width, height);
+///	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+/// delete[] data;
+unsigned char * loadBMPRGBA(const char * imagepath, unsigned int& outWidth, unsigned int& outHeight, bool flipY = true);
+
+/// Stride aware view of image rows (does not own the pixels).
+/// The stride is negative when the rows are viewed in the opposite order of the memory layout.
+struct ImageView {
+	const unsigned char * data; // first row
+	int width;
+	int height;
+	int stride;                 // bytes between rows (may be negative)
+	int bytesPerPixel;
+
+	const unsigned char * getRow(int y) const { return data + y * (ptrdiff_t)stride; }
+};
+
+/// A BMP file mapped into memory. The pixels are accessed directly in the mapping without
+/// copying. Row 0 is the bottom row of the image (as in the file for bottom-up BMP files) 
+/// unless flipY is true (like loadBMPRaw).
+/// Supports the same formats as loadBMPRGBA.
+///
+/// Example usage:
+/// MappedBMP bmp(imagepath);
+/// if (bmp.isValid()){
+///     glBindTexture(GL_TEXTURE_2D, textureID);
+///     bmp.upload(GL_TEXTURE_2D, 0);
+/// }
+class MappedBMP {
+public:
+	MappedBMP(const char * imagepath);
+	~MappedBMP();
+	bool isValid() { return pixelData != NULL; }
+	unsigned int getWidth() { return width; }
+	unsigned int getHeight() { return height; }
+	int getBitsPerPixel() { return bitsPerPixel; }
+	bool isCompressed() { return bottomRow == NULL; }
+	bool hasAlpha();
+	/// Returns a view of the rows in the file format (data is NULL for compressed files)
+	ImageView getView(bool flipY = true);
+	/// Convert the pixels to RGBA into outPixels (must have room for width*height*4 bytes)
+	bool decodeRGBA(unsigned char * outPixels, bool flipY = true);
+	/// Convert the pixels to RGBA. The returned char* must be deleted by the calling function.
+	unsigned char * decodeRGBA(bool flipY = true);
+	/// Upload the pixels to the currently bound texture. By default the bottom row is uploaded 
+	/// first (the OpenGL texture origin is the lower left corner), which for bottom-up files
+	/// (the common case) is a single upload directly from the mapping. 24 bit, 32 bit BGRA and
+	/// 565 pixels are uploaded from the mapping (if the rows must be reversed, e.g. flipY or
+	/// top-down files, they are copied once into a pixel buffer object), other formats are 
+	/// converted to RGBA first.
+	void upload(GLenum target, GLint level, bool flipY = false);
+private:
+	MappedBMP(const MappedBMP&);
+	MappedBMP& operator=(const MappedBMP&);
+	void unmap();
+	void decodeRLE8(unsigned char * outIndices);
+	void * mapping;
+	size_t mappingSize;
+#ifdef _WIN32
+	void * fileHandle;
+	void * mappingHandle;
+#endif
+	const unsigned char * pixelData; // start of the pixel data in the file
+	size_t dataSize;
+	const unsigned char * bottomRow; // NULL if compressed
+	int stride;                      // bytes from a row to the row above (including padding)
+	unsigned int width;
+	unsigned int height;
+	int bitsPerPixel;
+	int compression;
+	unsigned int masks[4];           // RGBA bit masks of 16 and 32 bit pixels
+	const unsigned char * palette;   // BGRX entries
+	int paletteSize;
+};
+
 #endif
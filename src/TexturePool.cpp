@@ -0,0 +1,86 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TexturePool.h"
+
+using namespace std;
+
+bool TexturePool::Key::operator <(const Key& rhs) const {
+    if (width != rhs.width) return width < rhs.width;
+    if (height != rhs.height) return height < rhs.height;
+    if (floatingPoint != rhs.floatingPoint) return floatingPoint < rhs.floatingPoint;
+    return mipmaps < rhs.mipmaps;
+}
+
+TexturePool::TexturePool(int maxFreeTexturesPerSize)
+:maxFreeTexturesPerSize(maxFreeTexturesPerSize), createdCount(0){
+}
+
+TexturePool::~TexturePool(){
+    trim();
+}
+
+Texture *TexturePool::acquire(GLuint width, GLuint height, bool floatingPoint, bool mipmaps){
+    Key key = {width, height, floatingPoint, mipmaps};
+    map<Key, vector<Texture*> >::iterator found = freeTextures.find(key);
+    if (found != freeTextures.end() && !found->second.empty()){
+        Texture *texture = found->second.back();
+        found->second.pop_back();
+        return texture;
+    }
+    createdCount++;
+    return new Texture(width, height, floatingPoint, mipmaps);
+}
+
+void TexturePool::release(Texture *texture){
+    if (texture == NULL){
+        return;
+    }
+    Key key = {texture->getWidth(), texture->getHeight(), texture->isFloatingPoint(), texture->hasMipmaps()};
+    vector<Texture*> &textures = freeTextures[key];
+    if (textures.size() >= maxFreeTexturesPerSize){
+        delete texture;
+        return;
+    }
+    textures.push_back(texture);
+}
+
+void TexturePool::trim(){
+    for (map<Key, vector<Texture*> >::iterator i = freeTextures.begin(); i != freeTextures.end(); i++){
+        for (int j=0;j<i->second.size();j++){
+            delete i->second[j];
+        }
+    }
+    freeTextures.clear();
+}
+
+int TexturePool::getFreeCount(){
+    int count = 0;
+    for (map<Key, vector<Texture*> >::iterator i = freeTextures.begin(); i != freeTextures.end(); i++){
+        count += i->second.size();
+    }
+    return count;
+}
@@ -0,0 +1,70 @@
+/*!
+ * OpenGL 3.2 Utils - Extension to the Angel library (from the book Interactive Computer Graphics 6th ed
+ * https://github.com/mortennobel/OpenGL_3_2_Utils
+ *
+ * New BSD License
+ *
+ * Copyright (c) 2011, Morten Nobel-Joergensen
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ * following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ * disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __TEXTURE_POOL_H
+#define __TEXTURE_POOL_H
+
+#include <map>
+#include <vector>
+#include "Angel.h"
+
+#include "Texture.h"
+
+// Recycles textures with the same size and format instead of creating and deleting
+// OpenGL texture objects. Textures acquired from the pool must be released to the 
+// pool (not deleted). The content of a recycled texture is undefined.
+// Example usage:
+//
+// TexturePool *pool = new TexturePool();
+// Texture *texture = pool->acquire(256, 256);
+// // use texture
+// pool->release(texture);
+class TexturePool {
+public:
+    TexturePool(int maxFreeTexturesPerSize = 8);
+    ~TexturePool();
+    // returns a free texture of the given size and format (or creates a new texture)
+    Texture *acquire(GLuint width, GLuint height, bool floatingPoint = false, bool mipmaps = false);
+    // return the texture to the pool
+    void release(Texture *texture);
+    // delete all free textures
+    void trim();
+    int getFreeCount();
+    int getCreatedCount() { return createdCount; }
+private:
+    struct Key {
+        GLuint width;
+        GLuint height;
+        bool floatingPoint;
+        bool mipmaps;
+        bool operator <(const Key& rhs) const;
+    };
+    std::map<Key, std::vector<Texture*> > freeTextures;
+    int maxFreeTexturesPerSize;
+    int createdCount;
+};
+
+#endif
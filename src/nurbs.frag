@@ -1,7 +1,14 @@
 #version 150
 
-uniform vec4 lightPosition;
-uniform vec4 color;
+layout(std140, row_major) uniform PerFrame {
+	mat4 projection;
+	vec4 lightPosition;
+};
+
+layout(std140, row_major) uniform PerObject {
+	mat4 modelView;
+	vec4 color;
+};
 
 in vec3 vNormal;
 in vec3 vPos;
@@ -1,7 +1,15 @@
 #version 150
 
-uniform mat4 projection;
-uniform mat4 modelView;
+// shared by all objects (updated once per frame)
+layout(std140, row_major) uniform PerFrame {
+	mat4 projection;
+	vec4 lightPosition;
+};
+
+layout(std140, row_major) uniform PerObject {
+	mat4 modelView;
+	vec4 color;
+};
 
 
 in vec4 position;
@@ -0,0 +1,94 @@
+#version 150
+
+// Evaluates a NURBS surface on the parameter grid used by NURBSSurface::getMeshData() (used by
+// NURBSGPUEvaluator). Each vertex is a grid point (gl_VertexID = i * discretization.y + j) and the
+// result is captured using transform feedback in the NURBSVertex layout.
+
+#define MAX_KNOTS 64
+
+// control points (x,y,z,w) ordered as NURBSSurface::getControlPoints()
+uniform samplerBuffer controlPoints;
+// knot vector u followed by knot vector v
+uniform samplerBuffer knots;
+uniform ivec2 numberOfControlPoints;
+uniform ivec2 degree;
+uniform ivec2 discretization;
+uniform vec2 minParameter;
+uniform vec2 deltaParameter;
+
+out vec4 position;
+out vec3 normal;
+out vec2 uv;
+
+// Computes the basis functions N(i, degree) for all control points using the Cox-de Boor
+// recursion evaluated bottom up (same result as NURBS::basisFunction())
+void basisFunctions(float u, int knotOffset, int controlPointCount, int p, out float N[MAX_KNOTS]){
+	int knotCount = controlPointCount + p + 1;
+	float knot[MAX_KNOTS];
+	for (int i = 0; i < knotCount; i++){
+		knot[i] = texelFetch(knots, knotOffset + i).x;
+	}
+	for (int i = 0; i < knotCount - 1; i++){
+		N[i] = knot[i] <= u && u < knot[i+1] ? 1.0 : 0.0;
+	}
+	for (int d = 1; d <= p; d++){
+		// N[i+1] still contains degree d-1 when N[i] is updated
+		for (int i = 0; i < knotCount - 1 - d; i++){
+			float divisor1 = knot[i + d] - knot[i];
+			float divisor2 = knot[i + d + 1] - knot[i + 1];
+			float result = 0.0;
+			if (divisor1 != 0.0) {
+				result += ((u - knot[i]) / divisor1) * N[i];
+			}
+			if (divisor2 != 0.0) {
+				result += ((knot[i + d + 1] - u) / divisor2) * N[i + 1];
+			}
+			N[i] = result;
+		}
+	}
+}
+
+vec3 evaluate(float Nu[MAX_KNOTS], float Nv[MAX_KNOTS]){
+	vec3 res = vec3(0.0);
+	float delimeter = 0.0;
+	for (int i = 0; i < numberOfControlPoints.x; i++){
+		for (int j = 0; j < numberOfControlPoints.y; j++){
+			vec4 controlPoint = texelFetch(controlPoints, i * numberOfControlPoints.y + j);
+			float val = controlPoint.w * Nu[i] * Nv[j];
+			res += controlPoint.xyz * val;
+			delimeter += val;
+		}
+	}
+	if (delimeter != 0.0){
+		res = res / delimeter;
+	}
+	return res;
+}
+
+void main(void)
+{
+	int i = gl_VertexID / discretization.y;
+	int j = gl_VertexID - i * discretization.y;
+	vec2 param = minParameter + vec2(i, j) / vec2(discretization - 1) * deltaParameter;
+
+	float Nu[MAX_KNOTS];
+	float Nv[MAX_KNOTS];
+	basisFunctions(param.x, 0, numberOfControlPoints.x, degree.x, Nu);
+	basisFunctions(param.y, numberOfControlPoints.x + degree.x + 1, numberOfControlPoints.y, degree.y, Nv);
+	position = vec4(evaluate(Nu, Nv), 1.0);
+	uv = param;
+
+	// central differences (as NURBSSurface::evaluateNormal())
+	vec2 delta = 0.1 / vec2(discretization - 1);
+	float NuPlus[MAX_KNOTS];
+	float NuMinus[MAX_KNOTS];
+	float NvPlus[MAX_KNOTS];
+	float NvMinus[MAX_KNOTS];
+	basisFunctions(min(0.9999, param.x + delta.x), 0, numberOfControlPoints.x, degree.x, NuPlus);
+	basisFunctions(max(0.0, param.x - delta.x), 0, numberOfControlPoints.x, degree.x, NuMinus);
+	basisFunctions(min(0.9999, param.y + delta.y), numberOfControlPoints.x + degree.x + 1, numberOfControlPoints.y, degree.y, NvPlus);
+	basisFunctions(max(0.0, param.y - delta.y), numberOfControlPoints.x + degree.x + 1, numberOfControlPoints.y, degree.y, NvMinus);
+	vec3 tangentU = evaluate(NuPlus, Nv) - evaluate(NuMinus, Nv);
+	vec3 tangentV = evaluate(Nu, NvPlus) - evaluate(Nu, NvMinus);
+	normal = normalize(cross(normalize(tangentV), normalize(tangentU)));
+}
@@ -0,0 +1,10 @@
+#version 150
+
+// object id (set using SelectBuffer::setId) 
+uniform uint objectId;
+
+out uvec2 fragId;
+
+void main(void) {
+	fragId = uvec2(objectId, uint(gl_PrimitiveID));
+}